@@ -0,0 +1,157 @@
+// Finds every anagram and sub-anagram of each rack in a file, e.g.
+//
+//     ./anagram racks.txt
+//     ./anagram -i DTDAWG_For_TWL06.img -e -t 8 racks.txt
+//
+// Each line of the file is a rack of letters, with "?" for a blank.  One line is
+// printed per rack, in input order: the rack, the number of words found and the words
+// themselves, with letters played by a blank in lower case.  Racks are read and
+// anagrammed a block at a time, so the input can be any size.  This replaces JPA's
+// interactive ADTDAWG_Anagram_For_Lexicon_14.
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adtdawg.h"
+#include "adtdawg_anagram.h"
+#include "command_line.h"
+
+using namespace std;
+
+// Zero worker threads means one per core.
+#define NUMBER_OF_WORKER_THREADS 0
+// Racks are read and anagrammed this many at a time.
+#define RACKS_PER_BLOCK 16384
+#define MAX_RACK_LENGTH 100
+
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [-i image_file] [-t threads] [-e] [-m min_length] <rack_file>\n",
+      program
+  );
+  fprintf(stderr, "  -i reads the lexicon from an image instead of the .dat files.\n");
+  fprintf(stderr, "  -e only finds words that use every tile.\n");
+  fprintf(stderr, "  -m skips words with fewer tiles than this.\n");
+  fprintf(stderr, "  A rack_file of - reads from stdin.\n");
+}
+
+// Reads up to RACKS_PER_BLOCK racks, skipping blank lines.
+bool ReadRacks(FILE *input, vector<string> *racks) {
+  char line[MAX_RACK_LENGTH + 2];
+  racks->clear();
+  while (racks->size() < RACKS_PER_BLOCK && fgets(line, sizeof(line), input)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0]) {
+      racks->push_back(line);
+    }
+  }
+  return !racks->empty();
+}
+
+int main(int argc, char *argv[]) {
+  const char *image_file = NULL;
+  uint32_t num_threads = NUMBER_OF_WORKER_THREADS;
+  AnagramOptions options = {true, 0};
+
+  int opt;
+  while ((opt = getopt(argc, argv, "i:t:em:")) != -1) {
+    switch (opt) {
+      case 'i':
+        image_file = optarg;
+        break;
+      case 't':
+        if (!ParseCount(optarg, 0, kMaxThreads, &num_threads)) {
+          fprintf(stderr, "Bad value for -t: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'e':
+        options.sub_anagrams = false;
+        break;
+      case 'm':
+        if (!ParseCount(optarg, 0, INT_MAX, &options.min_length)) {
+          fprintf(stderr, "Bad value for -m: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (argc - optind != 1) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+
+  unique_ptr<Adtdawg> dawg;
+  if (image_file) {
+    dawg = Adtdawg::MapImage(image_file);
+  } else {
+    dawg = Adtdawg::LoadFourPart(
+        FOUR_PART_DTDAWG_14_PART_ONE,
+        FOUR_PART_DTDAWG_14_PART_TWO,
+        FOUR_PART_DTDAWG_14_PART_THREE,
+        FOUR_PART_DTDAWG_14_PART_FOUR,
+        LEXICON_14_ALPHABET
+    );
+  }
+  if (!dawg.get()) {
+    return 1;
+  }
+
+  FILE *input = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "r");
+  if (!input) {
+    fprintf(stderr, "Error: Could not open file %s\n", argv[optind]);
+    return 1;
+  }
+
+  auto BeginWorkTime = chrono::steady_clock::now();
+  vector<string> racks;
+  uint64_t num_racks = 0;
+  uint64_t num_words = 0;
+  while (ReadRacks(input, &racks)) {
+    auto results = AnagramRacks(*dawg, racks, options, num_threads);
+    for (size_t i = 0; i < racks.size(); i++) {
+      fputs(racks[i].c_str(), stdout);
+      printf(" %zu", results[i].size());
+      for (const auto &word : results[i]) {
+        putchar(' ');
+        fputs(word.c_str(), stdout);
+      }
+      putchar('\n');
+      num_words += results[i].size();
+    }
+    num_racks += racks.size();
+  }
+  auto EndWorkTime = chrono::steady_clock::now();
+  double TheRunTime = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
+  if (input != stdin) {
+    fclose(input);
+  }
+
+  fprintf(
+      stderr,
+      "Anagrammed %llu racks into %llu words in %.3f seconds, %.2f racks/second\n",
+      (unsigned long long)num_racks,
+      (unsigned long long)num_words,
+      TheRunTime,
+      num_racks / TheRunTime
+  );
+  return 0;
+}
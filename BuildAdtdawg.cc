@@ -0,0 +1,207 @@
+// Builds an ADTDAWG from a word list, e.g.
+//
+//     ./buildadtdawg twl06.txt DTDAWG_For_TWL06.img
+//     ./buildadtdawg -a ACDEGILMNOPRST -l 15 -4 twl06.txt DTDAWG_For_Lexicon_14
+//
+// By default the image uses the child mask encoding, so it can hold the full 26 letter
+// alphabet.  -p switches to JPA's Part Two encoding, and -4 writes his four .dat files
+// (Four_Part_1_<name>.dat and so on, next to <name>) instead of an image.
+//
+// -u patches an existing image instead, keeping its encoding and layout:
+//
+//     ./buildadtdawg -u DTDAWG_For_TWL06.img house_rules.txt DTDAWG_For_TWL06.img
+//
+// Each line of the patch is a word to add, or to remove if it starts with "-".  The
+// whole image is decoded first, so a patch costs time in proportion to the lexicon;
+// what it saves over a rebuild is reading the word list and laying out every node.
+// The new image replaces the output atomically, so running scorers keep the old
+// mapping until they reload (gunsofnavarone -s does on SIGHUP), and scorers started
+// afterwards see the new one.
+//
+// -w also writes the table of word id spellings (see word_table.h) for the new
+// ADTDAWG.
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "adtdawg.h"
+#include "adtdawg_builder.h"
+#include "command_line.h"
+#include "word_table.h"
+
+using namespace std;
+
+#define FULL_ALPHABET "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [-a alphabet] [-l max_length] [-p] [-4] [-x] [-w word_table]\n"
+      "           <word_file> <output>\n"
+      "       %s -u base_image [-l max_length] [-4] [-c] [-w word_table]\n"
+      "           <patch_file> <output>\n",
+      program,
+      program
+  );
+  fprintf(stderr, "  -a keeps only words over these letters (default A-Z).\n");
+  fprintf(stderr, "  -l keeps only words of at most this many letters.\n");
+  fprintf(stderr, "  -p uses JPA's Part Two encoding (at most 18 letters).\n");
+  fprintf(stderr, "  -4 writes Four_Part_N_<output>.dat files (implies -p).\n");
+  fprintf(stderr, "  -x only shares identical child lists, not sublists.\n");
+  fprintf(stderr, "  -u adds and removes the patch's words from an existing image.\n");
+  fprintf(stderr, "  -c lays the patched image out afresh, dropping unused nodes.\n");
+  fprintf(stderr, "  -w also writes the word id to spelling table.\n");
+}
+
+int main(int argc, char *argv[]) {
+  string alphabet = FULL_ALPHABET;
+  uint32_t max_length = 0;
+  bool part_two = false;
+  bool four_part = false;
+  bool sublist_sharing = true;
+  const char *base_image = NULL;
+  bool compact = false;
+  const char *table_file = NULL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "a:l:p4xu:cw:")) != -1) {
+    switch (opt) {
+      case 'a':
+        alphabet = optarg;
+        break;
+      case 'l':
+        if (!ParseCount(optarg, 0, INT_MAX, &max_length)) {
+          fprintf(stderr, "Bad value for -l: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'p':
+        part_two = true;
+        break;
+      case '4':
+        part_two = four_part = true;
+        break;
+      case 'x':
+        sublist_sharing = false;
+        break;
+      case 'u':
+        base_image = optarg;
+        break;
+      case 'c':
+        compact = true;
+        break;
+      case 'w':
+        table_file = optarg;
+        break;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (argc - optind != 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  const char *word_file = argv[optind];
+  string output = argv[optind + 1];
+  for (char c : alphabet) {
+    if (c < 'A' || c > 'Z') {
+      fprintf(stderr, "The alphabet must be upper case letters\n");
+      return 1;
+    }
+  }
+
+  auto BeginWorkTime = chrono::steady_clock::now();
+  unique_ptr<AdtdawgBuilder> builder;
+  if (base_image) {
+    auto base = Adtdawg::MapImage(base_image);
+    if (!base.get()) {
+      return 1;
+    }
+    builder = AdtdawgBuilder::FromAdtdawg(*base, max_length);
+    if (!builder.get()) {
+      fprintf(stderr, "Couldn't patch %s\n", base_image);
+      return 1;
+    }
+    part_two = base->GetEncoding() == kPartTwoEncoding;
+    if (four_part && !part_two) {
+      fprintf(stderr, "Only a Part Two image can be written as four parts\n");
+      return 1;
+    }
+    if (compact) {
+      builder->Compact();
+    }
+    if (!builder->AddPatchFromFile(word_file)) {
+      return 1;
+    }
+  } else {
+    builder.reset(new AdtdawgBuilder(alphabet, max_length));
+    builder->SetSublistSharing(sublist_sharing);
+    if (!builder->AddWordsFromFile(word_file)) {
+      return 1;
+    }
+  }
+  auto dawg = part_two ? builder->BuildPartTwo() : builder->BuildChildMask();
+  if (!dawg.get()) {
+    return 1;
+  }
+
+  bool ok;
+  if (four_part) {
+    // The prefix goes on the file name, so the parts land in the output's directory.
+    size_t slash = output.rfind('/');
+    string directory = slash == string::npos ? "" : output.substr(0, slash + 1);
+    string name = output.substr(directory.size());
+    string parts[4];
+    for (int i = 0; i < 4; i++) {
+      parts[i] = directory + "Four_Part_" + to_string(i + 1) + "_" + name + ".dat";
+    }
+    ok = dawg->WriteFourPart(
+        parts[0].c_str(), parts[1].c_str(), parts[2].c_str(), parts[3].c_str()
+    );
+  } else {
+    ok = dawg->WriteImage(output.c_str());
+  }
+  unique_ptr<WordTable> table;
+  if (ok && table_file) {
+    table = WordTable::Build(*dawg);
+    ok = table.get() && table->Write(table_file);
+  }
+  if (!ok) {
+    return 1;
+  }
+  auto EndWorkTime = chrono::steady_clock::now();
+  double TheRunTime = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
+
+  if (base_image) {
+    printf(
+        "Patched %s: %zu words added, %zu removed\n",
+        base_image,
+        builder->NumWordsAdded(),
+        builder->NumWordsRemoved()
+    );
+  }
+  printf(
+      "Wrote %s: %u words, %zu DAWG states, %u nodes, %u child offsets, %zu bytes\n",
+      output.c_str(),
+      dawg->NumWords(),
+      builder->NumStates(),
+      dawg->NumNodes(),
+      dawg->NumChildOffsets(),
+      dawg->Bytes()
+  );
+  if (table.get()) {
+    printf(
+        "Wrote %s: %u words, %zu bytes\n", table_file, table->NumWords(), table->Bytes()
+    );
+  }
+  fprintf(stderr, "Built in %.3f seconds\n", TheRunTime);
+  return 0;
+}
@@ -2,24 +2,70 @@
 // boards starting at a predefined "MASTER_SEED_BOARD". The constants that
 // define the depth of the search...  NUMBER_OF_SEEDS_TO_RUN, ROUNDS,
 // BOARDS_PER_ROUND
+//
+// These constants, the list sizes, the alphabet and the dictionary are only defaults.
+// Each can be set with a long option, such as --rounds=10, or in a config file read
+// with --config, one "name = value" line per option (see ReadConfigFile).
+//
+// Deviations are scored on a pool of threads (-t sets how many), and the results are
+// the same for any number of threads.  For long searches, -p runs that many seeds at
+// once, each on its share of the threads.  The seeds share the master list and the
+// evaluated boards, and each new seed is the best unused board on the master list
+// when a thread frees up, so the results then depend on timing.
+//
+// The evaluated boards and seeds are kept as packed 128-bit keys (see board_set.h).
+// With -y, boards that are rotations or reflections of each other count as one.
+//
+// With --checkpoint, the search state is saved to a file every few minutes and again at
+// the end (see checkpoint.h), and --resume picks the search up from the file.  Seeds
+// that were running restart from the last round they finished, so with one seed at a
+// time a resumed run prints exactly what the original run would have from that round.
+//
+// With --coordinator, seeds run in worker processes instead (see search_protocol.h).
+// The coordinator keeps the search state and the workers, started with --worker or by
+// the coordinator with --local-workers, do the scoring.  A worker that dies only loses
+// the round it was on.
+//
+// With --strategy, the search runs on the scoring backend in search_strategy.h instead,
+// within a budget of --max-evaluations or --max-seconds, so that the locust swarm,
+// simulated annealing and beam search can be compared on the same number of boards
+// scored.  --moves=swaps or --moves=doubles adds two-cell moves to the locust swarm's
+// and beam search's single deviations.
 
 #include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include <algorithm>
-#include <format>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <ranges>
 #include <set>
 #include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
-#include "boggler.h"
+#include "board_set.h"
+#include "checkpoint.h"
 #include "insert.h"
+#include "scorer_pool.h"
+#include "search_codec.h"
+#include "search_protocol.h"
+#include "search_strategy.h"
 #include "trie.h"
 
 // General "Boggle" Constants.
@@ -27,7 +73,8 @@
 #define NUMBER_OF_ENGLISH_LETTERS 26
 #define SIZE_OF_CHARACTER_SET 14
 
-// These constant arrays define the lexicon contained in the ADTDAWG.
+// These constant arrays define the lexicon contained in the ADTDAWG.  This is the
+// default alphabet; --alphabet changes it.
 char CHARACTER_SET[SIZE_OF_CHARACTER_SET + 1] = {
     'A', 'C', 'D', 'E', 'G', 'I', 'L', 'M', 'N', 'O', 'P', 'R', 'S', 'T', ' '
 };
@@ -45,8 +92,89 @@ char CHARACTER_SET[SIZE_OF_CHARACTER_SET + 1] = {
 // number of boards analyzed per round.
 #define LIST_SIZE (BOARDS_PER_THREAD * SINGLE_DEVIATIONS)
 
+// Zero worker threads means one per core; this can be overridden with -t.
+#define NUMBER_OF_WORKER_THREADS 0
+// Seeds run at once; this can be overridden with -p.
+#define SEEDS_AT_ONCE 1
+// The evaluated boards are split into this many sets, each with its own lock.
+#define EVALUATED_BOARD_SHARDS 64
+// Minimum seconds between checkpoints; this can be overridden with
+// --checkpoint-interval.
+#define CHECKPOINT_INTERVAL 300
+// The default dictionary; --dictionary changes it.
+#define DICTIONARY "twl06.txt"
+// Once the search is done, seconds a coordinator waits for its workers to finish
+// before cutting them off.
+#define WORKER_GRACE_SECONDS 10
+// Defaults for the strategies other than the locust swarm; see search_strategy.h.
+#define BEAM_WIDTH 256
+#define START_TEMPERATURE 100.0
+#define END_TEMPERATURE 1.0
+
 using namespace std;
 
+// The boards that have been deviated, split into shards by hash so that seeds running
+// at once rarely wait on each other.
+class EvaluatedBoards {
+ public:
+  // With "canonical" set, a board's rotations and reflections count as the board.
+  explicit EvaluatedBoards(bool canonical) : canonical_(canonical) {}
+
+  PackedBoard Key(const PackedBoard &board) const {
+    return canonical_ ? CanonicalBoard(board) : board;
+  }
+  bool Contains(const PackedBoard &board) const {
+    PackedBoard key = Key(board);
+    const Shard &shard = shards_[key.Hash() % EVALUATED_BOARD_SHARDS];
+    lock_guard<mutex> lock(shard.lock);
+    return shard.boards.Contains(key);
+  }
+  void Insert(const PackedBoard &board) { InsertKey(Key(board)); }
+  // Inserts a board already made into a key by Key, such as one from a checkpoint.
+  void InsertKey(const PackedBoard &key) {
+    Shard &shard = shards_[key.Hash() % EVALUATED_BOARD_SHARDS];
+    lock_guard<mutex> lock(shard.lock);
+    shard.boards.Insert(key);
+  }
+  vector<PackedBoard> Keys() const {
+    vector<PackedBoard> keys;
+    for (const auto &shard : shards_) {
+      lock_guard<mutex> lock(shard.lock);
+      auto boards = shard.boards.Boards();
+      keys.insert(keys.end(), boards.begin(), boards.end());
+    }
+    return keys;
+  }
+  size_t Size() const {
+    size_t size = 0;
+    for (const auto &shard : shards_) {
+      lock_guard<mutex> lock(shard.lock);
+      size += shard.boards.Size();
+    }
+    return size;
+  }
+  size_t Bytes() const {
+    size_t bytes = 0;
+    for (const auto &shard : shards_) {
+      lock_guard<mutex> lock(shard.lock);
+      bytes += shard.boards.Bytes();
+    }
+    return bytes;
+  }
+
+ private:
+  struct Shard {
+    mutable mutex lock;
+    BoardSet boards;
+  };
+
+  const bool canonical_;
+  Shard shards_[EVALUATED_BOARD_SHARDS];
+};
+
+// Serializes output from the threads running seeds, so each block prints whole.
+mutex print_lock;
+
 void PrintBoardList(const vector<BoardScore> &list, int num_to_print = 10'000) {
   for (int i = 0; i < num_to_print && i < list.size(); i++) {
     const auto &b = list[i];
@@ -54,7 +182,7 @@ void PrintBoardList(const vector<BoardScore> &list, int num_to_print = 10'000) {
         "#%4d -|%5d|-|%s%02d|\n",
         i + 1,
         b.score,
-        b.board.board.c_str(),
+        UnpackBoard(b.board.board).c_str(),
         b.board.off_limit_cell
     );
   }
@@ -66,7 +194,7 @@ void PrintBestBoard(int round, const vector<BoardScore> &list) {
     printf(
         "\nRound|%d|, Best Board|%s%02d|, Best Score|%d|\n",
         round,
-        b.board.board.c_str(),
+        UnpackBoard(b.board.board).c_str(),
         b.board.off_limit_cell,
         b.score
     );
@@ -79,204 +207,1393 @@ void PrintBoard(const string &board) {
   printf("-----------\n");
 }
 
-void AddBoardsToMasterList(
-    vector<BoardScore> &MasterResults, const vector<BoardScore> &boards
+// The boards deviated in the round "progress" is on: the seed itself before round 0,
+// and then the top of the evaluate list.
+vector<BoardWithCell> RoundSources(
+    const SeedProgress &progress, const SearchParameters &parameters
 ) {
-  unsigned int min_score =
-      MasterResults.size() == MASTER_LIST_SIZE ? MasterResults.back().score : 0;
-  for (const auto &result : boards) {
-    if (result.score <= min_score) {
-      break;
-    }
-    InsertIntoMasterList(MasterResults, result);
+  if (progress.round < 0) {
+    return {{progress.seed.board.board, -1}};
+  }
+  vector<BoardWithCell> sources;
+  sources.reserve(parameters.boards_per_round);
+  auto to_evaluate = progress.evaluate_list | views::take(parameters.boards_per_round);
+  for (const auto &b : to_evaluate) {
+    sources.push_back(b.board);
   }
+  return sources;
 }
 
-vector<BoardScore> BuildEvalList(
-    const vector<BoardScore> &boards, const set<string> &all_evaluated_boards
+// Calls visit(score, make) for each single deviation of "sources," in order: by board,
+// then cell, then letter of the alphabet, skipping each board's off-limit cell and the
+// letter already in the cell.  "scores" holds the deviations' scores in that order.
+// make() returns the deviation as a BoardScore, so only the deviations a caller keeps
+// are spelled out as boards.
+template <typename Visit>
+void ForEachDeviation(
+    const vector<BoardWithCell> &sources,
+    const string &alphabet,
+    const vector<uint32_t> &scores,
+    Visit visit
 ) {
-  vector<BoardScore> next_eval_list;
-  for (const auto &board : boards) {
-    if (all_evaluated_boards.find(board.board.board) == all_evaluated_boards.end()) {
-      InsertIntoEvaluateList(next_eval_list, board);
+  size_t i = 0;
+  for (const auto &source : sources) {
+    for (int cell = 0; cell < SQUARE_COUNT; cell++) {
+      if (cell == source.off_limit_cell) continue;
+      char letter = source.board.Letter(cell);
+      for (char ch : alphabet) {
+        if (ch == letter) continue;
+        uint32_t score = scores[i++];
+        visit(score, [&] {
+          BoardWithCell deviation(source.board, cell);
+          deviation.board.SetLetter(cell, ch);
+          return BoardScore(score, deviation);
+        });
+      }
     }
   }
-  return next_eval_list;
 }
 
-int ScoreBoard(
-    const BoardWithCell &board,
-    Boggler<5, 5> *boggler,
-    vector<BoardScore> &MasterResults
-) {
-  auto score = boggler->Score(board.board.c_str());
+// The number of single deviations of "sources," as ForEachDeviation counts them.
+size_t CountDeviations(const vector<BoardWithCell> &sources, const string &alphabet) {
+  size_t count = 0;
+  for (const auto &source : sources) {
+    for (int cell = 0; cell < SQUARE_COUNT; cell++) {
+      if (cell != source.off_limit_cell) {
+        char letter = source.board.Letter(cell);
+        count += alphabet.size() - (alphabet.find(letter) != string::npos);
+      }
+    }
+  }
+  return count;
+}
+
+// Where a seed reports its rounds: the SharedSearch in this process, or a coordinator
+// in another (see search_protocol.h).
+class SeedHost {
+ public:
+  virtual ~SeedHost() {}
+
+  // Records the deviations of the round "progress" is on, given by their scores in the
+  // order ScoreSingleDeviations makes them, marks the boards they came from as
+  // evaluated, and moves "progress" on to the next round and its evaluate list.
+  // Returns false if the round couldn't be recorded.
+  virtual bool FinishRound(SeedProgress *progress, const vector<uint32_t> &scores) = 0;
+};
+
+// The master list and the boards chosen as seeds, shared by the seeds being run.  Each
+// seed adds a round's deviations under one lock, and NextSeed hands the best board
+// that hasn't been a seed to whichever thread or worker asks.  The search keeps the
+// progress of every running seed, so that a checkpoint can say where each one is and a
+// seed can be handed out again if its worker goes away.
+class SharedSearch : public SeedHost {
+ public:
+  SharedSearch(int num_seeds, const SearchParameters &parameters)
+      : evaluated(parameters.canonical),
+        parameters_(parameters),
+        num_seeds_(num_seeds),
+        seeds_started_(0),
+        seeds_running_(0),
+        checkpoints_(NULL),
+        print_rounds_(false) {
+    master_list_.reserve(parameters.master_list_size);
+  }
+
+  const SearchParameters &Parameters() const { return parameters_; }
+
+  // Checkpoints are sent to "checkpoints" as seeds finish rounds, when it says one is
+  // due.
+  void SetCheckpointWriter(CheckpointWriter *checkpoints) {
+    checkpoints_ = checkpoints;
+  }
+  // Prints each round's best boards as it starts.  Only sensible with one seed at once.
+  void SetPrintRounds(bool print_rounds) { print_rounds_ = print_rounds; }
+
+  // Adds "boards" to the master list in order.
+  void AddToMasterList(const vector<BoardScore> &boards) {
+    lock_guard<mutex> lock(lock_);
+    // Once the master list is full, its lowest score only goes up, so nothing at or
+    // below its lowest score before this batch can get on.
+    bool full = master_list_.size() == parameters_.master_list_size;
+    unsigned int min_score = full ? master_list_.back().score : 0;
+    for (const auto &board : boards) {
+      if (!full || board.score > min_score) {
+        InsertIntoMasterList(master_list_, board, parameters_.master_list_size);
+      }
+    }
+    seed_available_.notify_all();
+  }
+  // Adds the deviations of "sources" with "scores" to the master list, as above.
+  void AddToMasterList(
+      const vector<BoardWithCell> &sources, const vector<uint32_t> &scores
+  ) {
+    lock_guard<mutex> lock(lock_);
+    bool full = master_list_.size() == parameters_.master_list_size;
+    unsigned int min_score = full ? master_list_.back().score : 0;
+    ForEachDeviation(
+        sources, parameters_.character_set, scores, [&](uint32_t score, auto make) {
+          if (!full || score > min_score) {
+            InsertIntoMasterList(master_list_, make(), parameters_.master_list_size);
+          }
+        }
+    );
+    seed_available_.notify_all();
+  }
+  vector<BoardScore> MasterList() const {
+    lock_guard<mutex> lock(lock_);
+    return master_list_;
+  }
+
+  // Hands out seeds that are part way done first, where they left off.  After those,
+  // claims the best board on the master list that hasn't been a seed, numbered by its
+  // 1-based position among the seeds.  If every board on the list has been a seed,
+  // waits for a running seed to add one.  Returns false once all the seeds have been
+  // handed out, or if there's nothing left to try.
+  bool NextSeed(SeedProgress *progress) {
+    unique_lock<mutex> lock(lock_);
+    for (;;) {
+      if (!waiting_seeds_.empty()) {
+        *progress = waiting_seeds_.front();
+        waiting_seeds_.erase(waiting_seeds_.begin());
+        seeds_running_++;
+        return true;
+      }
+      if (seeds_started_ >= num_seeds_) {
+        return false;
+      }
+      for (const auto &result : master_list_) {
+        if (chosen_seeds_.Insert(evaluated.Key(result.board.board))) {
+          chosen_seed_boards_.push_back(result.board.board);
+          *progress = SeedProgress{++seeds_started_, result, -1, {}};
+          running_seeds_.insert_or_assign(progress->seed_number, *progress);
+          seeds_running_++;
+          return true;
+        }
+      }
+      if (seeds_running_ == 0) {
+        return false;
+      }
+      seed_available_.wait(lock);
+    }
+  }
+
+  bool FinishRound(SeedProgress *progress, const vector<uint32_t> &scores) override {
+    auto sources = RoundSources(*progress, parameters_);
+    AddToMasterList(sources, scores);
+    if (progress->round >= 0) {
+      for (const auto &source : sources) {
+        evaluated.Insert(source.board);
+      }
+    }
+    progress->evaluate_list = BuildEvalList(sources, scores);
+    progress->round++;
+    {
+      lock_guard<mutex> lock(lock_);
+      running_seeds_.insert_or_assign(progress->seed_number, *progress);
+      if (checkpoints_ && checkpoints_->Due()) {
+        checkpoints_->Write(SnapshotLocked());
+      }
+    }
+    if (progress->round < (int)parameters_.rounds) {
+      PrintRound(*progress);
+    }
+    return true;
+  }
+  // If rounds are being printed, prints the best boards as "progress"'s round starts.
+  void PrintRound(const SeedProgress &progress) const {
+    if (!print_rounds_) {
+      return;
+    }
+    // Even if nothing qualifies for the master list on this round, print out
+    // the best result for the round to keep track of the progress.
+    lock_guard<mutex> lock(print_lock);
+    PrintBestBoard(progress.round, progress.evaluate_list);
+    printf("\nThe Top 10 Off The Master List After Round |%d|.\n", progress.round);
+    PrintBoardList(MasterList(), 10);
+  }
+
+  void SeedDone(int seed_number) {
+    lock_guard<mutex> lock(lock_);
+    running_seeds_.erase(seed_number);
+    seeds_running_--;
+    seed_available_.notify_all();
+  }
+  // Puts a running seed back to be handed out again from the last round it finished,
+  // for when the worker running it goes away.
+  void ReturnSeed(int seed_number) {
+    lock_guard<mutex> lock(lock_);
+    auto it = running_seeds_.find(seed_number);
+    if (it != running_seeds_.end()) {
+      waiting_seeds_.push_back(it->second);
+      seeds_running_--;
+      seed_available_.notify_all();
+    }
+  }
+  // Waits until no seed is running and NextSeed has no more to hand out.
+  void WaitUntilDone() const {
+    unique_lock<mutex> lock(lock_);
+    seed_available_.wait(lock, [this] {
+      if (seeds_running_ > 0 || !waiting_seeds_.empty()) {
+        return false;
+      }
+      if (seeds_started_ >= num_seeds_) {
+        return true;
+      }
+      for (const auto &result : master_list_) {
+        if (!chosen_seeds_.Contains(evaluated.Key(result.board.board))) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  unique_ptr<SearchCheckpoint> Snapshot() const {
+    lock_guard<mutex> lock(lock_);
+    return SnapshotLocked();
+  }
+  // Restores the state saved in "checkpoint," which must have been made with the same
+  // parameters, into a new SharedSearch.
+  void Restore(const SearchCheckpoint &checkpoint) {
+    lock_guard<mutex> lock(lock_);
+    seeds_started_ = checkpoint.seeds_started;
+    master_list_ = checkpoint.master_list;
+    chosen_seed_boards_ = checkpoint.chosen_seeds;
+    for (const auto &board : chosen_seed_boards_) {
+      chosen_seeds_.Insert(evaluated.Key(board));
+    }
+    waiting_seeds_ = checkpoint.running_seeds;
+    for (const auto &progress : waiting_seeds_) {
+      running_seeds_.insert_or_assign(progress.seed_number, progress);
+    }
+    for (const auto &key : checkpoint.evaluated) {
+      evaluated.InsertKey(key);
+    }
+  }
+  // The seeds in alphabetical order.
+  vector<string> ChosenSeeds() const {
+    lock_guard<mutex> lock(lock_);
+    vector<string> boards;
+    for (const auto &board : chosen_seed_boards_) {
+      boards.push_back(UnpackBoard(board));
+    }
+    sort(boards.begin(), boards.end());
+    return boards;
+  }
+  size_t ChosenSeedBytes() const {
+    lock_guard<mutex> lock(lock_);
+    return chosen_seeds_.Bytes();
+  }
+
+  EvaluatedBoards evaluated;
+
+ private:
+  // The best deviations of "sources" that haven't been evaluated.  Only a deviation
+  // that beats the lowest score on a full list is looked up and inserted.
+  vector<BoardScore> BuildEvalList(
+      const vector<BoardWithCell> &sources, const vector<uint32_t> &scores
+  ) const {
+    vector<BoardScore> next_eval_list;
+    uint32_t max_size = parameters_.evaluate_list_size;
+    next_eval_list.reserve(max_size);
+    ForEachDeviation(
+        sources, parameters_.character_set, scores, [&](uint32_t score, auto make) {
+          bool full = next_eval_list.size() == max_size;
+          if (full && score <= next_eval_list.back().score) {
+            return;
+          }
+          BoardScore board = make();
+          if (!evaluated.Contains(board.board.board)) {
+            InsertIntoEvaluateList(next_eval_list, board, max_size);
+          }
+        }
+    );
+    return next_eval_list;
+  }
+
+  unique_ptr<SearchCheckpoint> SnapshotLocked() const {
+    unique_ptr<SearchCheckpoint> checkpoint(new SearchCheckpoint);
+    checkpoint->parameters = parameters_;
+    checkpoint->seeds_started = seeds_started_;
+    checkpoint->master_list = master_list_;
+    checkpoint->chosen_seeds = chosen_seed_boards_;
+    for (const auto &[seed_number, progress] : running_seeds_) {
+      checkpoint->running_seeds.push_back(progress);
+    }
+    checkpoint->evaluated = evaluated.Keys();
+    return checkpoint;
+  }
+
+  mutable mutex lock_;
+  mutable condition_variable seed_available_;
+  const SearchParameters parameters_;
+  vector<BoardScore> master_list_;
+  BoardSet chosen_seeds_;
+  vector<PackedBoard> chosen_seed_boards_;
+  const int num_seeds_;
+  int seeds_started_;
+  int seeds_running_;
+  // Seeds that have been handed out and not finished, by seed number.
+  map<int, SeedProgress> running_seeds_;
+  // Seeds part way done that are waiting to be handed out: the ones running when the
+  // checkpoint this search resumed from was made, and any whose worker went away.
+  vector<SeedProgress> waiting_seeds_;
+  CheckpointWriter *checkpoints_;
+  bool print_rounds_;
+};
+
+int ScoreBoard(const BoardWithCell &board, ScorerPool *scorers, SharedSearch *search) {
+  auto score = scorers->Score(board.board);
   assert(score >= 0);
-  InsertIntoMasterList(MasterResults, {static_cast<unsigned int>(score), board});
+  search->AddToMasterList({{static_cast<unsigned int>(score), board}});
   return score;
 }
 
-vector<BoardScore> GenerateSingleDeviations(
-    const vector<BoardWithCell> &boards,
-    Boggler<5, 5> *boggler,
-    vector<BoardScore> &MasterResults
+// Each (board, cell) pair is one task for the scorer pool.  Every task writes the
+// scores of its deviations into its own slots, which are laid out in the order a
+// single thread would generate them (see ForEachDeviation), and the lists are updated
+// from the slots in that order once they are all scored.  So the results don't depend
+// on the number of threads.  Only the scores are kept, four bytes a deviation; the
+// boards are spelled out again for the few that make a list.
+vector<uint32_t> ScoreSingleDeviations(
+    const vector<BoardWithCell> &boards, const string &alphabet, ScorerPool *scorers
 ) {
-  vector<BoardScore> deviations;
-  deviations.reserve(boards.size() * (SQUARE_COUNT - 1) * (SIZE_OF_CHARACTER_SET - 1));
-
-  for (const auto &board : boards) {
-    auto off_limit_cell = board.off_limit_cell;
+  vector<size_t> first_slot(boards.size() * SQUARE_COUNT + 1, 0);
+  for (size_t b = 0; b < boards.size(); b++) {
     for (int cell = 0; cell < SQUARE_COUNT; cell++) {
-      if (cell == off_limit_cell) continue;
-      BoardWithCell temp_board(board.board, cell);
-      auto orig_char = board.board[cell];
-      for (int i = 0; i < SIZE_OF_CHARACTER_SET; i++) {
-        auto ch = CHARACTER_SET[i];
-        if (ch == orig_char) continue;
-        temp_board.board[cell] = ch;
-        auto score = ScoreBoard(temp_board, boggler, MasterResults);
-        deviations.push_back(BoardScore(score, temp_board));
+      size_t task = b * SQUARE_COUNT + cell;
+      size_t count = 0;
+      if (cell != boards[b].off_limit_cell) {
+        count = alphabet.size();
+        if (alphabet.find(boards[b].board.Letter(cell)) != string::npos) {
+          count--;
+        }
       }
+      first_slot[task + 1] = first_slot[task] + count;
     }
   }
 
-  return deviations;
+  vector<uint32_t> scores(first_slot.back());
+  auto deviate = [&](uint32_t thread, size_t task) {
+    const auto &board = boards[task / SQUARE_COUNT];
+    int cell = task % SQUARE_COUNT;
+    if (cell == board.off_limit_cell) return;
+    char temp_board[SQUARE_COUNT + 1];
+    UnpackBoard(board.board, temp_board);
+    auto orig_char = temp_board[cell];
+    size_t slot = first_slot[task];
+    for (auto ch : alphabet) {
+      if (ch == orig_char) continue;
+      temp_board[cell] = ch;
+      auto score = scorers->Score(thread, temp_board);
+      assert(score >= 0);
+      scores[slot++] = score;
+    }
+  };
+  scorers->ForEach(boards.size() * SQUARE_COUNT, deviate);
+  return scores;
 }
 
-vector<BoardScore> RunOneSeed(
-    const string &seed_board,
-    Boggler<5, 5> *boggler,
-    vector<BoardScore> &MasterResults,
-    set<string> &AllEvaluatedBoards
+// Runs the seed in "progress" from its round through the last one, reporting each
+// round to "host."  Returns false if the host can't be reached.
+bool RunOneSeed(
+    SeedProgress *progress,
+    const SearchParameters &parameters,
+    ScorerPool *scorers,
+    SeedHost *host
 ) {
-  auto seed_variations =
-      GenerateSingleDeviations({{seed_board, -1}}, boggler, MasterResults);
+  // This Loop Represents the rounds cascade.  Deviate the top boards; the host marks
+  // them as "evaluated."
+  while (progress->round < (int)parameters.rounds) {
+    auto scores = ScoreSingleDeviations(
+        RoundSources(*progress, parameters), parameters.character_set, scorers
+    );
+    if (!host->FinishRound(progress, scores)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  auto evaluate_list = BuildEvalList(seed_variations, AllEvaluatedBoards);
+void PrintSeedStart(const SeedProgress &progress) {
+  lock_guard<mutex> lock(print_lock);
+  if (progress.round < 0) {
+    printf(
+        "For the |%d|'th run the seed board is |%s| worth |%d| points.\n",
+        progress.seed_number,
+        UnpackBoard(progress.seed.board.board).c_str(),
+        progress.seed.score
+    );
+  } else {
+    printf(
+        "Resuming the |%d|'th run, seed board |%s| worth |%d| points, at round "
+        "|%d|.\n",
+        progress.seed_number,
+        UnpackBoard(progress.seed.board.board).c_str(),
+        progress.seed.score,
+        progress.round
+    );
+  }
+}
 
-  // This Loop Represents the rounds cascade.
-  for (int T = 0; T < ROUNDS; T++) {
-    // Even if nothing qualifies for the master list on this round, print out
-    // the best result for the round to keep track of the progress.
-    PrintBestBoard(T, evaluate_list);
-    printf("\nThe Top 10 Off The Master List After Round |%d|.\n", T);
-    PrintBoardList(MasterResults, 10);
+// Prints a finished seed's results as one block, so seeds finishing at once don't
+// interleave.
+void PrintSeedResults(const SeedProgress &progress, const SharedSearch &search) {
+  lock_guard<mutex> lock(print_lock);
+  auto MasterResults = search.MasterList();
+  // Even if nothing qualifies for the master list on this round, print out
+  // the best result for the round to keep track of the progress.
+  PrintBestBoard(progress.round, progress.evaluate_list);
+
+  // The last round is now complete, so we have to get ready for the next
+  // seed.
+  printf("\nThe Top 10 Off The Master List After Round |%d|.\n", progress.round);
+  PrintBoardList(MasterResults, 10);
+  printf("\n");
+
+  printf(
+      "At this point, |%zu| boards have been placed on the evaluation "
+      "queue, and have been singularly deviated.\n",
+      search.evaluated.Size()
+  );
+
+  // Print out everything on the master results list after running each chain
+  // seed.
+  printf("\nThe Master List After Seed |%d|.\n", progress.seed_number);
+  PrintBoardList(MasterResults);
+}
+
+// Runs seeds from "search" until they're all done.
+void RunSeeds(ScorerPool *scorers, SharedSearch *search) {
+  SeedProgress progress{0, BoardScore(0, {PackedBoard{0, 0}, 0}), -1, {}};
+  while (search->NextSeed(&progress)) {
+    PrintSeedStart(progress);
+    if (progress.round >= 0) {
+      search->PrintRound(progress);
+    }
+    RunOneSeed(&progress, search->Parameters(), scorers, search);
+    PrintSeedResults(progress, *search);
+    search->SeedDone(progress.seed_number);
+  }
+}
+
+// Serves one worker: hands it seeds and records its rounds until the search runs out
+// of seeds or the worker goes away.  A seed the worker doesn't finish goes back to be
+// handed out again from its last finished round.
+void ServeWorker(int fd, SharedSearch *search) {
+  SearchEncoder parameters;
+  parameters.Parameters(search->Parameters());
+  bool ok = SendSearchMessage(fd, kParameters, parameters.bytes);
+  SearchMessageType type;
+  vector<uint8_t> payload;
+  if (!ok || !ReceiveSearchMessage(fd, &type, &payload) || type != kDictionary) {
+    return;
+  }
+  SearchDecoder dictionary(payload.data(), payload.size());
+  SearchParameters worker_parameters = search->Parameters();
+  worker_parameters.dictionary_words = dictionary.Varint();
+  worker_parameters.dictionary_hash = dictionary.Varint();
+  if (!dictionary.Ok() || !dictionary.AtEnd() ||
+      !worker_parameters.SameDictionary(search->Parameters())) {
+    fprintf(stderr, "Refusing a worker whose dictionary doesn't match\n");
+    shutdown(fd, SHUT_RDWR);
+    return;
+  }
+  bool has_seed = false;
+  SeedProgress progress{0, BoardScore(0, {PackedBoard{0, 0}, 0}), -1, {}};
+  while (ok && ReceiveSearchMessage(fd, &type, &payload)) {
+    SearchDecoder in(payload.data(), payload.size());
+    if (type == kSeedRequest && !has_seed) {
+      if (!search->NextSeed(&progress)) {
+        SendSearchMessage(fd, kNoMoreSeeds, {});
+        break;
+      }
+      has_seed = true;
+      PrintSeedStart(progress);
+      SearchEncoder out;
+      out.Progress(progress);
+      ok = SendSearchMessage(fd, kSeed, out.bytes);
+    } else if (type == kRoundDone && has_seed) {
+      int seed_number = in.Varint();
+      int round = (int)in.Varint() - 1;
+      auto scores = in.Integers();
+      const SearchParameters &parameters = search->Parameters();
+      auto sources = RoundSources(progress, parameters);
+      ok = in.Ok() && in.AtEnd() && seed_number == progress.seed_number &&
+           round == progress.round &&
+           scores.size() == CountDeviations(sources, parameters.character_set);
+      if (ok) {
+        search->FinishRound(&progress, scores);
+        SearchEncoder out;
+        out.Scores(progress.evaluate_list);
+        ok = SendSearchMessage(fd, kEvaluateList, out.bytes);
+      }
+    } else if (type == kSeedDone && has_seed) {
+      int seed_number = in.Varint();
+      ok = in.Ok() && in.AtEnd() && seed_number == progress.seed_number &&
+           progress.round == (int)search->Parameters().rounds;
+      if (ok) {
+        PrintSeedResults(progress, *search);
+        search->SeedDone(seed_number);
+        has_seed = false;
+      }
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      fprintf(stderr, "Bad message (type %d) from a worker\n", type);
+    }
+  }
+  if (has_seed) {
+    fprintf(
+        stderr,
+        "Lost the worker running seed %d; it will run again from round %d\n",
+        progress.seed_number,
+        progress.round
+    );
+    search->ReturnSeed(progress.seed_number);
+  }
+}
+
+// Accepts workers on "listen_fd" and serves them until the search is done.  Workers
+// can join at any time, and leave: their seeds go to the next worker that asks.
+void RunCoordinator(int listen_fd, SharedSearch *search) {
+  vector<int> worker_fds;
+  vector<thread> workers;
+  mutex served_lock;
+  condition_variable served;
+  size_t num_served = 0;
+  thread acceptor([&] {
+    for (;;) {
+      int fd = accept(listen_fd, NULL, NULL);
+      if (fd < 0 && errno == EINTR) {
+        continue;
+      }
+      if (fd < 0) {
+        return;  // the listening socket has been shut down
+      }
+      worker_fds.push_back(fd);
+      workers.emplace_back([&, fd] {
+        ServeWorker(fd, search);
+        lock_guard<mutex> lock(served_lock);
+        num_served++;
+        served.notify_all();
+      });
+    }
+  });
+
+  search->WaitUntilDone();
+  shutdown(listen_fd, SHUT_RDWR);
+  acceptor.join();
+  // Every worker still connected is told there are no more seeds when it next asks
+  // for one, which ends its thread.  One that hasn't asked within the grace period is
+  // hung, so its connection is shut down to end the thread anyway.
+  {
+    unique_lock<mutex> lock(served_lock);
+    served.wait_for(lock, chrono::seconds(WORKER_GRACE_SECONDS), [&] {
+      return num_served == workers.size();
+    });
+  }
+  for (int fd : worker_fds) {
+    shutdown(fd, SHUT_RDWR);
+  }
+  for (auto &t : workers) {
+    t.join();
+  }
+  for (int fd : worker_fds) {
+    close(fd);
+  }
+}
 
-    // Deviate the top boards and mark them as "evaluated."
-    auto to_evaluate = evaluate_list | views::take(BOARDS_PER_ROUND);
+// A worker's view of its coordinator.
+class CoordinatorConnection : public SeedHost {
+ public:
+  explicit CoordinatorConnection(int fd) : fd_(fd) {}
 
-    vector<BoardWithCell> sources;
-    sources.reserve(BOARDS_PER_ROUND);
-    for (const auto &b : to_evaluate) {
-      sources.push_back(b.board);
+  bool FinishRound(SeedProgress *progress, const vector<uint32_t> &scores) override {
+    SearchEncoder out;
+    out.Varint(progress->seed_number);
+    out.Varint(progress->round + 1);
+    out.Integers(scores);
+    SearchMessageType type;
+    vector<uint8_t> payload;
+    if (!SendSearchMessage(fd_, kRoundDone, out.bytes) ||
+        !ReceiveSearchMessage(fd_, &type, &payload) || type != kEvaluateList) {
+      return false;
     }
-    auto deviations = GenerateSingleDeviations(sources, boggler, MasterResults);
-    for (const auto &b : to_evaluate) {
-      AllEvaluatedBoards.insert(b.board.board);
+    SearchDecoder in(payload.data(), payload.size());
+    progress->evaluate_list = in.Scores();
+    progress->round++;
+    return in.Ok() && in.AtEnd();
+  }
+
+ private:
+  const int fd_;
+};
+
+// Runs seeds for the coordinator at "socket_path" until it has no more.  Returns false
+// if the coordinator can't be reached or goes away.
+bool RunWorker(
+    const string &socket_path, const string &dictionary, uint32_t num_threads
+) {
+  int fd = ConnectToUnixSocket(socket_path);
+  if (fd < 0) {
+    return false;
+  }
+  CoordinatorConnection coordinator(fd);
+  SearchMessageType type;
+  vector<uint8_t> payload;
+  bool ok = ReceiveSearchMessage(fd, &type, &payload) && type == kParameters;
+  SearchDecoder in(payload.data(), payload.size());
+  SearchParameters parameters = in.Parameters();
+  ok = ok && in.Ok() && in.AtEnd();
+  unique_ptr<ScorerPool> scorers;
+  if (ok) {
+    scorers = ScorerPool::Create(
+        dictionary.c_str(), parameters.character_set, num_threads
+    );
+    if (!scorers) {
+      fprintf(stderr, "Unable to load dictionary %s\n", dictionary.c_str());
+      ok = false;
+    }
+  }
+  // The coordinator checks the dictionary too, but only the worker can say which file
+  // is wrong.
+  if (ok) {
+    SearchEncoder loaded;
+    loaded.Varint(scorers->NumWords());
+    loaded.Varint(scorers->DictionaryHash());
+    ok = SendSearchMessage(fd, kDictionary, loaded.bytes);
+    if (ok && (scorers->NumWords() != parameters.dictionary_words ||
+               scorers->DictionaryHash() != parameters.dictionary_hash)) {
+      fprintf(
+          stderr,
+          "%s doesn't match the coordinator's dictionary\n",
+          dictionary.c_str()
+      );
+      close(fd);
+      return false;
     }
+  }
+  while (ok) {
+    if (!SendSearchMessage(fd, kSeedRequest, {}) ||
+        !ReceiveSearchMessage(fd, &type, &payload)) {
+      ok = false;
+      break;
+    }
+    if (type == kNoMoreSeeds) {
+      break;
+    }
+    SearchDecoder seed(payload.data(), payload.size());
+    SeedProgress progress = seed.Progress();
+    ok = type == kSeed && seed.Ok() && seed.AtEnd() &&
+         RunOneSeed(&progress, parameters, scorers.get(), &coordinator);
+    if (ok) {
+      SearchEncoder done;
+      done.Varint(progress.seed_number);
+      ok = SendSearchMessage(fd, kSeedDone, done.bytes);
+    }
+  }
+  if (!ok) {
+    fprintf(stderr, "Lost the coordinator at %s\n", socket_path.c_str());
+  }
+  close(fd);
+  return ok;
+}
 
-    evaluate_list = BuildEvalList(deviations, AllEvaluatedBoards);
+// Waits for the local workers to exit, killing any still running after the grace
+// period.
+void ReapLocalWorkers(const vector<pid_t> &pids) {
+  auto deadline = chrono::steady_clock::now() + chrono::seconds(WORKER_GRACE_SECONDS);
+  for (pid_t pid : pids) {
+    while (waitpid(pid, NULL, WNOHANG) == 0) {
+      if (chrono::steady_clock::now() >= deadline) {
+        fprintf(stderr, "Killing worker %d, which didn't exit\n", (int)pid);
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        break;
+      }
+      this_thread::sleep_for(chrono::milliseconds(10));
+    }
   }
+}
 
-  return evaluate_list;
+// Starts "count" copies of this program as workers for the coordinator at
+// "socket_path," and returns their process ids.
+vector<pid_t> StartLocalWorkers(
+    uint32_t count,
+    const string &socket_path,
+    const string &dictionary,
+    uint32_t threads_per_worker
+) {
+  vector<pid_t> pids;
+  string worker = "--worker=" + socket_path;
+  string dictionary_option = "--dictionary=" + dictionary;
+  string threads = "--threads=" + to_string(threads_per_worker);
+  for (uint32_t i = 0; i < count; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      execl(
+          "/proc/self/exe",
+          "deepsearch",
+          worker.c_str(),
+          dictionary_option.c_str(),
+          threads.c_str(),
+          (char *)NULL
+      );
+      perror("execl");
+      _exit(1);
+    }
+    if (pid < 0) {
+      perror("fork");
+      break;
+    }
+    pids.push_back(pid);
+  }
+  return pids;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int main() {
-  // The seed board selection process is beyond the scope of this program.
-  // For now, choose seeds that are as different as possible and verify that
-  // they all produce the same results.
-  string SeedBoard(MASTER_SEED_BOARD);
-
-  // The Master List - now using vector
-  std::vector<BoardScore> MasterResults;
-  MasterResults.reserve(MASTER_LIST_SIZE);
+// Everything that can be set on the command line or in a config file.
+struct DeepSearchOptions {
+  int num_seeds = NUMBER_OF_SEEDS_TO_RUN;
+  SearchParameters parameters{
+      ROUNDS,
+      BOARDS_PER_ROUND,
+      EVALUATE_LIST_SIZE,
+      MASTER_LIST_SIZE,
+      false,
+      string(CHARACTER_SET, SIZE_OF_CHARACTER_SET),
+      0,  // the dictionary is filled in once it's loaded
+      0
+  };
+  string seed_board = MASTER_SEED_BOARD;
+  string dictionary = DICTIONARY;
+  uint32_t num_threads = NUMBER_OF_WORKER_THREADS;
+  uint32_t seeds_at_once = SEEDS_AT_ONCE;
+  string checkpoint_file;
+  double checkpoint_interval = CHECKPOINT_INTERVAL;
+  bool resume = false;
+  string coordinator_socket;
+  uint32_t local_workers = 0;
+  string worker_socket;
+  string strategy;
+  SearchBudget budget{0, 0};
+  uint32_t beam_width = BEAM_WIDTH;
+  double start_temperature = START_TEMPERATURE;
+  double end_temperature = END_TEMPERATURE;
+  uint32_t moves_per_step = 0;  // one per scoring thread
+  uint64_t random_seed = 1;
+  TwoCellMoves two_cell_moves = kNoTwoCellMoves;
+};
 
-  // These "MinBoardTrie"s will maintain information about the search so that
-  // new boards will continue to be evaluated.  This is an important construct
-  // to a search algorithm.
-  set<string> AllEvaluatedBoards;
-  set<string> ChosenSeedBoards;
+// Options without a short form.
+enum {
+  kSeedsOption = 256,
+  kRoundsOption,
+  kBoardsPerRoundOption,
+  kEvaluateListSizeOption,
+  kMasterListSizeOption,
+  kAlphabetOption,
+  kSeedBoardOption,
+  kDictionaryOption,
+  kConfigOption,
+  kCoordinatorOption,
+  kLocalWorkersOption,
+  kWorkerOption,
+  kStrategyOption,
+  kMaxEvaluationsOption,
+  kMaxSecondsOption,
+  kBeamWidthOption,
+  kStartTemperatureOption,
+  kEndTemperatureOption,
+  kMovesPerStepOption,
+  kRandomSeedOption,
+  kMovesOption,
+};
 
-  // Allocate the global variables for board processing
+const struct option kLongOptions[] = {
+    {"seeds", required_argument, NULL, kSeedsOption},
+    {"rounds", required_argument, NULL, kRoundsOption},
+    {"boards-per-round", required_argument, NULL, kBoardsPerRoundOption},
+    {"evaluate-list-size", required_argument, NULL, kEvaluateListSizeOption},
+    {"master-list-size", required_argument, NULL, kMasterListSizeOption},
+    {"alphabet", required_argument, NULL, kAlphabetOption},
+    {"seed-board", required_argument, NULL, kSeedBoardOption},
+    {"dictionary", required_argument, NULL, kDictionaryOption},
+    {"config", required_argument, NULL, kConfigOption},
+    {"threads", required_argument, NULL, 't'},
+    {"seeds-at-once", required_argument, NULL, 'p'},
+    {"canonical", no_argument, NULL, 'y'},
+    {"checkpoint", required_argument, NULL, 'c'},
+    {"checkpoint-interval", required_argument, NULL, 'i'},
+    {"resume", no_argument, NULL, 'r'},
+    {"coordinator", required_argument, NULL, kCoordinatorOption},
+    {"local-workers", required_argument, NULL, kLocalWorkersOption},
+    {"worker", required_argument, NULL, kWorkerOption},
+    {"strategy", required_argument, NULL, kStrategyOption},
+    {"max-evaluations", required_argument, NULL, kMaxEvaluationsOption},
+    {"max-seconds", required_argument, NULL, kMaxSecondsOption},
+    {"beam-width", required_argument, NULL, kBeamWidthOption},
+    {"start-temperature", required_argument, NULL, kStartTemperatureOption},
+    {"end-temperature", required_argument, NULL, kEndTemperatureOption},
+    {"moves-per-step", required_argument, NULL, kMovesPerStepOption},
+    {"random-seed", required_argument, NULL, kRandomSeedOption},
+    {"moves", required_argument, NULL, kMovesOption},
+    {NULL, 0, NULL, 0}
+};
 
-  printf(
-      "DoubleUp.c Variables - Chain Seeds |%d|, Single Deviation Rounds "
-      "|%d|, Full Evaluations Per Round |%d|.\n\n",
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [options]\n"
+      "  --seeds=N                seeds to run (%d)\n"
+      "  --rounds=N               rounds per seed (%d)\n"
+      "  --boards-per-round=N     boards deviated each round (%d)\n"
+      "  --evaluate-list-size=N   boards kept for the next round (%d)\n"
+      "  --master-list-size=N     best boards kept overall (%d)\n"
+      "  --alphabet=LETTERS       letters boards are made of (%.*s)\n"
+      "  --seed-board=BOARD       the first seed, 25 letters (%s)\n"
+      "  --dictionary=FILE        word list (%s)\n"
+      "  --config=FILE            reads \"name = value\" lines naming these options\n"
+      "  -t, --threads=N          scoring threads, 0 for one per core\n"
+      "  -p, --seeds-at-once=N    seeds run at once (%d)\n"
+      "  -y, --canonical          count rotations and reflections as one board\n"
+      "  -c, --checkpoint=FILE    saves the search state to FILE\n"
+      "  -i, --checkpoint-interval=SECONDS  (%d)\n"
+      "  -r, --resume             resumes from the --checkpoint file\n"
+      "  --coordinator=SOCKET     runs seeds in workers connecting to SOCKET\n"
+      "  --local-workers=N        starts N workers for the coordinator\n"
+      "  --worker=SOCKET          runs seeds for the coordinator at SOCKET\n"
+      "  --strategy=NAME          locust, annealing or beam, on one scoring backend\n"
+      "  --max-evaluations=N      stops the strategy after scoring N boards\n"
+      "  --max-seconds=SECONDS    stops the strategy after SECONDS\n"
+      "  --beam-width=N           boards kept each generation of beam (%d)\n"
+      "  --start-temperature=T    annealing's first temperature (%g)\n"
+      "  --end-temperature=T      annealing's last temperature (%g)\n"
+      "  --moves-per-step=N       annealing moves scored at once, 0 for one a thread\n"
+      "  --random-seed=N          annealing's random seed\n"
+      "  --moves=KIND             single, swaps or doubles: the moves locust and beam\n"
+      "                           try (single)\n"
+      "Options are applied in order, so later ones override a config file's.\n",
+      program,
       NUMBER_OF_SEEDS_TO_RUN,
       ROUNDS,
-      BOARDS_PER_ROUND
+      BOARDS_PER_ROUND,
+      EVALUATE_LIST_SIZE,
+      MASTER_LIST_SIZE,
+      SIZE_OF_CHARACTER_SET,
+      CHARACTER_SET,
+      MASTER_SEED_BOARD,
+      DICTIONARY,
+      SEEDS_AT_ONCE,
+      CHECKPOINT_INTERVAL,
+      BEAM_WIDTH,
+      START_TEMPERATURE,
+      END_TEMPERATURE
   );
+}
 
-  auto trie = Trie::CreateFromFile("twl06.txt");
-  if (!trie.get()) {
-    fprintf(stderr, "Unable to load dictionary\n");
-    return 1;
+// Parses a whole decimal number of at least "min."  Returns false if "value" isn't one.
+bool ParseCount(const char *value, long min, uint32_t *count) {
+  char *end;
+  errno = 0;
+  long n = strtol(value, &end, 10);
+  if (end == value || *end || errno || n < min || n > INT_MAX) {
+    return false;
+  }
+  *count = n;
+  return true;
+}
+
+// Parses a whole decimal number that fits in 64 bits.
+bool ParseCount64(const char *value, uint64_t *count) {
+  char *end;
+  errno = 0;
+  unsigned long long n = strtoull(value, &end, 10);
+  if (end == value || *end || errno || value[0] == '-') {
+    return false;
   }
-  auto boggler = new Boggler<5, 5>(trie.get());
+  *count = n;
+  return true;
+}
 
-  auto init_score = ScoreBoard({SeedBoard, 0}, boggler, MasterResults);
+// Parses a number of at least zero, or above zero if "positive."
+bool ParseNumber(const char *value, bool positive, double *number) {
+  char *end;
+  double n = strtod(value, &end);
+  if (end == value || *end || !(positive ? n > 0 : n >= 0)) {
+    return false;
+  }
+  *number = n;
+  return true;
+}
+
+bool ReadConfigFile(const char *filename, DeepSearchOptions *options);
+
+// Applies option "opt," as returned by getopt_long, with "value" as its argument.
+// Returns false if the value isn't valid for the option.
+bool SetOption(int opt, const char *value, DeepSearchOptions *options) {
+  SearchParameters &parameters = options->parameters;
+  uint32_t count;
+  switch (opt) {
+    case kSeedsOption:
+      if (!ParseCount(value, 1, &count)) return false;
+      options->num_seeds = count;
+      return true;
+    case kRoundsOption:
+      return ParseCount(value, 0, &parameters.rounds);
+    case kBoardsPerRoundOption:
+      return ParseCount(value, 1, &parameters.boards_per_round);
+    case kEvaluateListSizeOption:
+      return ParseCount(value, 1, &parameters.evaluate_list_size);
+    case kMasterListSizeOption:
+      return ParseCount(value, 1, &parameters.master_list_size);
+    case kAlphabetOption:
+      parameters.character_set = value;
+      for (auto &c : parameters.character_set) {
+        c = toupper(c);
+      }
+      return true;
+    case kSeedBoardOption:
+      options->seed_board = value;
+      for (auto &c : options->seed_board) {
+        c = toupper(c);
+      }
+      return true;
+    case kDictionaryOption:
+      options->dictionary = value;
+      return true;
+    case kConfigOption:
+      return ReadConfigFile(value, options);
+    case 't':
+      return ParseCount(value, 0, &options->num_threads);
+    case 'p':
+      return ParseCount(value, 1, &options->seeds_at_once);
+    case 'y':
+      parameters.canonical = true;
+      return true;
+    case 'c':
+      options->checkpoint_file = value;
+      return true;
+    case 'i':
+      return ParseNumber(value, false, &options->checkpoint_interval);
+    case 'r':
+      options->resume = true;
+      return true;
+    case kCoordinatorOption:
+      options->coordinator_socket = value;
+      return true;
+    case kLocalWorkersOption:
+      return ParseCount(value, 0, &options->local_workers);
+    case kWorkerOption:
+      options->worker_socket = value;
+      return true;
+    case kStrategyOption:
+      options->strategy = value;
+      return options->strategy == "locust" || options->strategy == "annealing" ||
+             options->strategy == "beam";
+    case kMaxEvaluationsOption:
+      return ParseCount64(value, &options->budget.max_evaluations);
+    case kMaxSecondsOption:
+      return ParseNumber(value, false, &options->budget.max_seconds);
+    case kBeamWidthOption:
+      return ParseCount(value, 1, &options->beam_width);
+    case kStartTemperatureOption:
+      return ParseNumber(value, true, &options->start_temperature);
+    case kEndTemperatureOption:
+      return ParseNumber(value, true, &options->end_temperature);
+    case kMovesPerStepOption:
+      return ParseCount(value, 0, &options->moves_per_step);
+    case kRandomSeedOption:
+      return ParseCount64(value, &options->random_seed);
+    case kMovesOption:
+      if (strcmp(value, "single") == 0) {
+        options->two_cell_moves = kNoTwoCellMoves;
+      } else if (strcmp(value, "swaps") == 0) {
+        options->two_cell_moves = kSwaps;
+      } else if (strcmp(value, "doubles") == 0) {
+        options->two_cell_moves = kDoubleDeviations;
+      } else {
+        return false;
+      }
+      return true;
+  }
+  return false;
+}
+
+// Reads options from "filename."  Each line is "name = value" with the long name of an
+// option, or just "name" for an option without a value.  Blank lines and anything after
+// a "#" are ignored.
+bool ReadConfigFile(const char *filename, DeepSearchOptions *options) {
+  FILE *f = fopen(filename, "r");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", filename);
+    return false;
+  }
+  auto trim = [](string s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return begin == string::npos ? string() : s.substr(begin, end - begin + 1);
+  };
+  char buffer[1024];
+  bool ok = true;
+  for (int line_number = 1; ok && fgets(buffer, sizeof(buffer), f); line_number++) {
+    string line(buffer);
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+    size_t equals = line.find('=');
+    string name = trim(line.substr(0, equals));
+    string value = equals == string::npos ? "" : trim(line.substr(equals + 1));
+    const struct option *o = kLongOptions;
+    while (o->name && name != o->name) {
+      o++;
+    }
+    if (!o->name) {
+      fprintf(
+          stderr,
+          "%s:%d: unknown option \"%s\"\n",
+          filename,
+          line_number,
+          name.c_str()
+      );
+      ok = false;
+    } else if ((o->has_arg == no_argument) != value.empty() ||
+               !SetOption(o->val, value.c_str(), options)) {
+      fprintf(stderr, "%s:%d: bad value for %s\n", filename, line_number, o->name);
+      ok = false;
+    }
+  }
+  fclose(f);
+  return ok;
+}
+
+// Checks the options that depend on each other.  Returns false and explains why if they
+// don't make sense together.
+bool ValidateOptions(const DeepSearchOptions &options) {
+  const string &alphabet = options.parameters.character_set;
+  if (alphabet.empty()) {
+    fprintf(stderr, "The alphabet is empty\n");
+    return false;
+  }
+  for (size_t i = 0; i < alphabet.size(); i++) {
+    if (alphabet[i] < 'A' || alphabet[i] > 'Z' ||
+        alphabet.find(alphabet[i], i + 1) != string::npos) {
+      fprintf(
+          stderr, "The alphabet must be distinct letters, not %s\n", alphabet.c_str()
+      );
+      return false;
+    }
+  }
+  const string &board = options.seed_board;
+  bool board_ok = board.size() == SQUARE_COUNT;
+  for (char c : board) {
+    board_ok = board_ok && alphabet.find(c) != string::npos;
+  }
+  if (!board_ok) {
+    fprintf(
+        stderr,
+        "The seed board must be %d letters from the alphabet, not %s\n",
+        SQUARE_COUNT,
+        board.c_str()
+    );
+    return false;
+  }
+  if (!options.coordinator_socket.empty() && !options.worker_socket.empty()) {
+    fprintf(stderr, "A process can't be both a coordinator and a worker\n");
+    return false;
+  }
+  if (options.local_workers > 0 && options.coordinator_socket.empty()) {
+    fprintf(stderr, "--local-workers needs --coordinator\n");
+    return false;
+  }
+  if (options.resume && options.checkpoint_file.empty()) {
+    fprintf(stderr, "--resume needs a --checkpoint file to resume from\n");
+    return false;
+  }
+  const SearchBudget &budget = options.budget;
+  bool has_budget = budget.max_evaluations > 0 || budget.max_seconds > 0;
+  if (has_budget && options.strategy.empty()) {
+    fprintf(stderr, "A budget needs a --strategy\n");
+    return false;
+  }
+  if (options.two_cell_moves != kNoTwoCellMoves && options.strategy.empty()) {
+    fprintf(stderr, "--moves needs a --strategy\n");
+    return false;
+  }
+  if (!options.strategy.empty()) {
+    if (options.strategy != "locust" && !has_budget) {
+      fprintf(
+          stderr,
+          "--strategy=%s needs --max-evaluations or --max-seconds\n",
+          options.strategy.c_str()
+      );
+      return false;
+    }
+    if (options.strategy == "annealing" && options.two_cell_moves != kNoTwoCellMoves) {
+      fprintf(stderr, "--moves is for the locust and beam strategies\n");
+      return false;
+    }
+    if (!options.coordinator_socket.empty() || !options.worker_socket.empty() ||
+        !options.checkpoint_file.empty()) {
+      fprintf(
+          stderr, "--strategy runs in one process, without workers or checkpoints\n"
+      );
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs --strategy on one scoring backend and prints the best boards it found.  Returns
+// false if the dictionary can't be read.
+bool RunStrategy(const DeepSearchOptions &options, uint32_t num_threads) {
+  const SearchParameters &parameters = options.parameters;
+  auto scorers = ScorerPool::Create(
+      options.dictionary.c_str(), parameters.character_set, num_threads
+  );
+  if (!scorers) {
+    fprintf(stderr, "Unable to load dictionary %s\n", options.dictionary.c_str());
+    return false;
+  }
+  unique_ptr<SearchStrategy> strategy;
+  if (options.strategy == "annealing") {
+    uint32_t moves = options.moves_per_step;
+    strategy.reset(new AnnealingStrategy(
+        options.start_temperature,
+        options.end_temperature,
+        moves ? moves : scorers->NumThreads(),
+        options.random_seed
+    ));
+  } else if (options.strategy == "beam") {
+    strategy.reset(new BeamSearchStrategy(options.beam_width, options.two_cell_moves));
+  } else {
+    strategy.reset(new LocustSwarmStrategy(options.num_seeds, options.two_cell_moves));
+  }
+  SearchBackend backend(scorers.get(), parameters, options.budget);
+  fprintf(
+      stderr,
+      "Running the %s strategy, scoring on %u threads\n",
+      strategy->Name(),
+      backend.NumThreads()
+  );
+  strategy->Run(PackBoard(options.seed_board.c_str()), &backend);
 
   printf(
-      "This is the original seed board that will be used...  It is worth "
-      "|%d| points.  Sleep for 2 seconds to look at it\n\n",
-      init_score
+      "Strategy |%s|, Evaluations |%lu|, Cache Hits |%lu|, Pruned |%lu|, "
+      "Seconds |%.1f|\n\n",
+      strategy->Name(),
+      (unsigned long)backend.Evaluations(),
+      (unsigned long)backend.CacheHits(),
+      (unsigned long)backend.Pruned(),
+      backend.Seconds()
   );
-  PrintBoard(SeedBoard);
-
-  // This loop represents the chain seeds cascade.
-  for (int S = 0; S < NUMBER_OF_SEEDS_TO_RUN; S++) {
-    BoardScore seed_score(-1, {"", 0});
-    for (const auto &result : MasterResults) {
-      if (ChosenSeedBoards.find(result.board.board) == ChosenSeedBoards.end()) {
-        seed_score = result;
-        break;
+  PrintBoardList(backend.Best());
+  fprintf(stderr, "Scores cached and boards expanded in %zu bytes\n", backend.Bytes());
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  DeepSearchOptions options;
+  int opt;
+  while ((opt = getopt_long(argc, argv, "t:p:yc:i:r", kLongOptions, NULL)) != -1) {
+    if (opt == '?') {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    if (!SetOption(opt, optarg, &options)) {
+      if (opt != kConfigOption) {
+        // A short option's value can be the next argument: "-i 5."
+        const char *name =
+            argv[optind - 1] == optarg ? argv[optind - 2] : argv[optind - 1];
+        fprintf(stderr, "Bad value for %s: %s\n", name, optarg);
       }
+      return 1;
     }
-    assert(seed_score.score >= 0);
-    auto seed = seed_score.board;
-    ChosenSeedBoards.insert(seed.board);
+  }
+  if (optind < argc) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  if (!ValidateOptions(options)) {
+    return 1;
+  }
+  SearchParameters parameters = options.parameters;
+  const char *checkpoint_file = options.checkpoint_file.c_str();
+  uint32_t seeds_at_once = options.seeds_at_once;
+  uint32_t num_threads = options.num_threads;
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+  // A worker gets everything else from its coordinator.
+  if (!options.worker_socket.empty()) {
+    return RunWorker(options.worker_socket, options.dictionary, num_threads) ? 0 : 1;
+  }
+  if (!options.strategy.empty()) {
+    return RunStrategy(options, num_threads) ? 0 : 1;
+  }
+  bool coordinating = !options.coordinator_socket.empty();
+  if (coordinating) {
+    seeds_at_once = 1;  // only used to score the seed board
+  }
 
-    printf(
-        "For the |%d|'th run the seed board is |%s| worth |%d| points.\n",
-        S + 1,
-        seed.board.c_str(),
-        seed_score.score
+  // The seed board selection process is beyond the scope of this program.
+  // For now, choose seeds that are as different as possible and verify that
+  // they all produce the same results.
+  string SeedBoard(options.seed_board);
+
+  // Each seed running at once gets its own scorers and an even share of the threads.
+  vector<unique_ptr<ScorerPool>> scorers;
+  for (uint32_t i = 0; i < seeds_at_once; i++) {
+    uint32_t threads_per_seed = max(1u, num_threads / seeds_at_once);
+    scorers.push_back(ScorerPool::Create(
+        options.dictionary.c_str(), parameters.character_set, threads_per_seed
+    ));
+    if (!scorers.back().get()) {
+      fprintf(stderr, "Unable to load dictionary %s\n", options.dictionary.c_str());
+      return 1;
+    }
+  }
+  parameters.dictionary_words = scorers[0]->NumWords();
+  parameters.dictionary_hash = scorers[0]->DictionaryHash();
+
+  // The master list, the boards chosen as seeds and the boards that have been
+  // evaluated maintain information about the search so that new boards will
+  // continue to be evaluated.  This is an important construct to a search algorithm.
+  SharedSearch search(options.num_seeds, parameters);
+  if (options.resume) {
+    SearchCheckpoint checkpoint;
+    if (!ReadCheckpoint(checkpoint_file, &checkpoint)) {
+      return 1;
+    }
+    if (!checkpoint.parameters.SameDictionary(parameters)) {
+      fprintf(
+          stderr,
+          "%s was made with a different dictionary than %s; not resuming\n",
+          checkpoint_file,
+          options.dictionary.c_str()
+      );
+      return 1;
+    }
+    if (!(checkpoint.parameters == parameters)) {
+      fprintf(
+          stderr,
+          "%s was made with different search parameters; not resuming\n",
+          checkpoint_file
+      );
+      return 1;
+    }
+    search.Restore(checkpoint);
+    fprintf(
+        stderr,
+        "Resuming from %s: %d seeds started, %zu running, %zu boards evaluated\n",
+        checkpoint_file,
+        checkpoint.seeds_started,
+        checkpoint.running_seeds.size(),
+        checkpoint.evaluated.size()
     );
+  }
+  unique_ptr<CheckpointWriter> checkpoints;
+  if (!options.checkpoint_file.empty()) {
+    checkpoints.reset(
+        new CheckpointWriter(checkpoint_file, options.checkpoint_interval)
+    );
+    search.SetCheckpointWriter(checkpoints.get());
+  }
 
-    auto TopEvaluationBoardList =
-        RunOneSeed(seed.board, boggler, MasterResults, AllEvaluatedBoards);
+  printf(
+      "DoubleUp.c Variables - Chain Seeds |%d|, Single Deviation Rounds "
+      "|%d|, Full Evaluations Per Round |%d|.\n\n",
+      options.num_seeds,
+      parameters.rounds,
+      parameters.boards_per_round
+  );
 
-    // Even if nothing qualifies for the master list on this round, print out
-    // the best result for the round to keep track of the progress.
-    PrintBestBoard(ROUNDS, TopEvaluationBoardList);
+  if (!coordinating) {
+    fprintf(
+        stderr,
+        "Running %u seeds at once, each scoring on %u threads\n",
+        seeds_at_once,
+        scorers[0]->NumThreads()
+    );
+  }
 
-    // The last round is now complete, so we have to get ready for the next
-    // seed.
-    printf("\nThe Top 10 Off The Master List After Round |%d|.\n", ROUNDS);
-    PrintBoardList(MasterResults, 10);
-    printf("\n");
+  // A resumed search already has the original seed board on its master list.
+  if (!options.resume) {
+    auto init_score =
+        ScoreBoard({PackBoard(SeedBoard.c_str()), 0}, scorers[0].get(), &search);
 
     printf(
-        "At this point, |%zu| boards have been placed on the evaluation "
-        "queue, and have been singularly deviated.\n",
-        AllEvaluatedBoards.size()
+        "This is the original seed board that will be used...  It is worth "
+        "|%d| points.  Sleep for 2 seconds to look at it\n\n",
+        init_score
     );
+    PrintBoard(SeedBoard);
+  }
 
-    // Print out everything on the master results list after running each chain
-    // seed.
-    printf("\nThe Master List After Seed |%d|.\n", S + 1);
-    PrintBoardList(MasterResults);
+  // This represents the chain seeds cascade.  Per-round progress is only printed when
+  // one seed runs at a time in this process.
+  if (coordinating) {
+    const string &socket_path = options.coordinator_socket;
+    int listen_fd = ListenOnUnixSocket(socket_path);
+    if (listen_fd < 0) {
+      return 1;
+    }
+    uint32_t threads_per_worker = max(1u, num_threads / max(1u, options.local_workers));
+    auto pids = StartLocalWorkers(
+        options.local_workers, socket_path, options.dictionary, threads_per_worker
+    );
+    fprintf(
+        stderr,
+        "Coordinating at %s with %zu local workers, each scoring on %u threads\n",
+        socket_path.c_str(),
+        pids.size(),
+        threads_per_worker
+    );
+    RunCoordinator(listen_fd, &search);
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    ReapLocalWorkers(pids);
+  } else {
+    search.SetPrintRounds(seeds_at_once == 1);
+    vector<thread> threads;
+    for (uint32_t i = 1; i < seeds_at_once; i++) {
+      threads.emplace_back(RunSeeds, scorers[i].get(), &search);
+    }
+    RunSeeds(scorers[0].get(), &search);
+    for (auto &t : threads) {
+      t.join();
+    }
+  }
+  if (checkpoints) {
+    checkpoints->Write(search.Snapshot());
+    checkpoints.reset();  // waits for the write
   }
 
   // Produce a list of the boards used as seeds when done, and wait for the user
   // to look at, and store the results if they want to.
+  auto ChosenSeedBoards = search.ChosenSeeds();
   printf("The boards used as seed boards are as follows:..\n");
   printf("This Min Board Trie Contains |%zu| Boards.\n", ChosenSeedBoards.size());
   for (const auto &board : ChosenSeedBoards) {
     printf("|%s|\n", board.c_str());
   }
 
+  size_t num_evaluated = search.evaluated.Size();
+  size_t evaluated_bytes = search.evaluated.Bytes();
+  fprintf(
+      stderr,
+      "Evaluated boards: %zu in %zu bytes (%.1f bytes/board), seeds: %zu in %zu bytes\n",
+      num_evaluated,
+      evaluated_bytes,
+      num_evaluated ? (double)evaluated_bytes / num_evaluated : 0.0,
+      ChosenSeedBoards.size(),
+      search.ChosenSeedBytes()
+  );
+
   return 0;
 }
 
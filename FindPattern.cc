@@ -0,0 +1,113 @@
+// Lists the words matching crossword-style patterns, e.g.
+//
+//     ./findpattern 'C?T' '*ING' '[AEIOU]*[^S]'
+//     ./findpattern -i DTDAWG_For_TWL06.img -m 5 -M 7 'QU*'
+//
+// "?" is any letter, "*" any run of letters and "[...]" a letter class; see
+// adtdawg_pattern.h.  Each match is printed as its word id and the word, and the
+// number of matches and the search time for each pattern go to stderr.
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "adtdawg.h"
+#include "adtdawg_pattern.h"
+#include "command_line.h"
+
+using namespace std;
+
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [-i image_file] [-m min_length] [-M max_length] <pattern>...\n",
+      program
+  );
+  fprintf(stderr, "  -i reads the lexicon from an image instead of the .dat files.\n");
+  fprintf(stderr, "  -m and -M bound the length of the words, counting QU as two.\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *image_file = NULL;
+  uint32_t min_length = 0;
+  uint32_t max_length = 0;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "i:m:M:")) != -1) {
+    switch (opt) {
+      case 'i':
+        image_file = optarg;
+        break;
+      case 'm':
+        if (!ParseCount(optarg, 0, INT_MAX, &min_length)) {
+          fprintf(stderr, "Bad value for -m: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'M':
+        if (!ParseCount(optarg, 0, INT_MAX, &max_length)) {
+          fprintf(stderr, "Bad value for -M: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind == argc) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  unique_ptr<Adtdawg> dawg;
+  if (image_file) {
+    dawg = Adtdawg::MapImage(image_file);
+  } else {
+    dawg = Adtdawg::LoadFourPart(
+        FOUR_PART_DTDAWG_14_PART_ONE,
+        FOUR_PART_DTDAWG_14_PART_TWO,
+        FOUR_PART_DTDAWG_14_PART_THREE,
+        FOUR_PART_DTDAWG_14_PART_FOUR,
+        LEXICON_14_ALPHABET
+    );
+  }
+  if (!dawg.get()) {
+    return 1;
+  }
+  PatternSearcher searcher(*dawg);
+
+  for (int i = optind; i < argc; i++) {
+    size_t num_found = 0;
+    auto BeginWorkTime = chrono::steady_clock::now();
+    bool ok = searcher.Search(
+        argv[i],
+        min_length,
+        max_length,
+        [&num_found](uint32_t word_id, const string &word) {
+          printf("%u %s\n", word_id, word.c_str());
+          num_found++;
+        }
+    );
+    auto EndWorkTime = chrono::steady_clock::now();
+    if (!ok) {
+      return 1;
+    }
+    double TheRunTime = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
+    fprintf(
+        stderr,
+        "%s: %zu words in %.1f microseconds\n",
+        argv[i],
+        num_found,
+        TheRunTime * 1e6
+    );
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Lists the words on Boggle boards with the cells that spell them, e.g.
+//
+//     ./findwords SERSPATGLINESERSPATGLINES
+//     ./findwords -i DTDAWG_For_TWL06.img -r 4 -c 4 QUTOEPRSLAINDEBT
+//
+// For each board, prints the number of words and the total score, and then one line
+// per word: its id, its spelling and the cells spelling it, numbered in rows from 0.
+// With no -i, the four-part Lexicon_14 files and their word table are used; with -i
+// and no -W, the word table is built from the image.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "adtdawg.h"
+#include "adtdawg_boggler.h"
+#include "command_line.h"
+#include "word_table.h"
+
+using namespace std;
+
+uint32_t SCORES[] = {0, 0, 0, 1, 1, 2, 3, 5, 11};
+
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [-i image_file] [-W word_table] [-r rows] [-c columns] [-m] "
+      "<board>...\n",
+      program
+  );
+  fprintf(stderr, "  -i reads the lexicon from an image instead of the .dat files.\n");
+  fprintf(stderr, "  -W reads the word ids' spellings from a word table.\n");
+  fprintf(stderr, "  -r and -c give the board's size (default 5x5).\n");
+  fprintf(stderr, "  -m lists a word once for each set of cells that spells it.\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *image_file = NULL;
+  const char *table_file = NULL;
+  uint32_t rows = 5;
+  uint32_t columns = 5;
+  bool multiboggle = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "i:W:r:c:m")) != -1) {
+    switch (opt) {
+      case 'i':
+        image_file = optarg;
+        break;
+      case 'W':
+        table_file = optarg;
+        break;
+      case 'r':
+        if (!ParseCount(optarg, 1, AdtdawgBoggler::kMaxCells, &rows)) {
+          fprintf(stderr, "Bad value for -r: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'c':
+        if (!ParseCount(optarg, 1, AdtdawgBoggler::kMaxCells, &columns)) {
+          fprintf(stderr, "Bad value for -c: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'm':
+        multiboggle = true;
+        break;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind == argc || rows * columns > AdtdawgBoggler::kMaxCells) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  unique_ptr<Adtdawg> dawg;
+  if (image_file) {
+    dawg = Adtdawg::MapImage(image_file);
+  } else {
+    dawg = Adtdawg::LoadFourPart(
+        FOUR_PART_DTDAWG_14_PART_ONE,
+        FOUR_PART_DTDAWG_14_PART_TWO,
+        FOUR_PART_DTDAWG_14_PART_THREE,
+        FOUR_PART_DTDAWG_14_PART_FOUR,
+        LEXICON_14_ALPHABET
+    );
+    if (!table_file) {
+      table_file = WORD_TABLE_14;
+    }
+  }
+  if (!dawg.get()) {
+    return 1;
+  }
+  unique_ptr<WordTable> table =
+      table_file ? WordTable::Load(table_file) : WordTable::Build(*dawg);
+  if (!table.get()) {
+    return 1;
+  }
+  if (table->NumWords() != dawg->NumWords()) {
+    fprintf(
+        stderr,
+        "The word table has %u words but the lexicon has %u\n",
+        table->NumWords(),
+        dawg->NumWords()
+    );
+    return 1;
+  }
+
+  AdtdawgBoggler boggler(*dawg, rows, columns);
+  vector<FoundWord> words;
+  for (int i = optind; i < argc; i++) {
+    if (!boggler.FindWords(argv[i], multiboggle, &words)) {
+      return 1;
+    }
+    vector<string> spellings;
+    uint32_t score = 0;
+    for (const auto &word : words) {
+      spellings.push_back(table->Word(word.word_id));
+      score += SCORES[min<size_t>(spellings.back().size(), 8)];
+    }
+    printf("%s: %zu words, score %u\n", argv[i], words.size(), score);
+    for (size_t w = 0; w < words.size(); w++) {
+      printf("%u %s", words[w].word_id, spellings[w].c_str());
+      for (size_t j = 0; j < words[w].path.size(); j++) {
+        printf("%c%d", j ? ',' : ' ', words[w].path[j]);
+      }
+      putchar('\n');
+    }
+  }
+  return 0;
+}
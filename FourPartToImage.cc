@@ -0,0 +1,48 @@
+// Converts JPA's four-part ADTDAWG data files into a single aligned image that
+// GunsOfNavarone can map read-only with "-i".
+
+#include <stdio.h>
+
+#include "adtdawg.h"
+
+int main(int argc, char *argv[]) {
+  const char *parts[4] = {
+      FOUR_PART_DTDAWG_14_PART_ONE,
+      FOUR_PART_DTDAWG_14_PART_TWO,
+      FOUR_PART_DTDAWG_14_PART_THREE,
+      FOUR_PART_DTDAWG_14_PART_FOUR
+  };
+  const char *image_file = DTDAWG_14_IMAGE;
+
+  if (argc == 2) {
+    image_file = argv[1];
+  } else if (argc == 6) {
+    for (int i = 0; i < 4; i++) {
+      parts[i] = argv[i + 1];
+    }
+    image_file = argv[5];
+  } else if (argc != 1) {
+    fprintf(stderr, "Usage: %s [part1 part2 part3 part4] [image_file]\n", argv[0]);
+    return 1;
+  }
+
+  auto dawg = Adtdawg::LoadFourPart(
+      parts[0], parts[1], parts[2], parts[3], LEXICON_14_ALPHABET
+  );
+  if (!dawg.get()) {
+    return 1;
+  }
+  if (!dawg->WriteImage(image_file)) {
+    return 1;
+  }
+
+  printf(
+      "Wrote %s: %u nodes, %u child offsets, %u words, %zu bytes\n",
+      image_file,
+      dawg->NumNodes(),
+      dawg->NumChildOffsets(),
+      dawg->NumWords(),
+      dawg->Bytes()
+  );
+  return 0;
+}
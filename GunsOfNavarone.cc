@@ -1,65 +1,48 @@
 #include <ctype.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>  // Ensure this is included for clock()
+#include <unistd.h>
 
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <string>
+#include <thread>
 #include <vector>
 
-using namespace std;
+#include "GunsOfNavarone.h"
+#include "adtdawg.h"
+#include "bounded_queue.h"
+#include "command_line.h"
 
-// The ADTDAWG for Lexicon_14, a subset of TWL06, is located in the 4 data files listed
-// below.
-#define FOUR_PART_DTDAWG_14_PART_ONE "Four_Part_1_DTDAWG_For_Lexicon_14.dat"
-#define FOUR_PART_DTDAWG_14_PART_TWO "Four_Part_2_DTDAWG_For_Lexicon_14.dat"
-#define FOUR_PART_DTDAWG_14_PART_THREE "Four_Part_3_DTDAWG_For_Lexicon_14.dat"
-#define FOUR_PART_DTDAWG_14_PART_FOUR "Four_Part_4_DTDAWG_For_Lexicon_14.dat"
-
-// General "Boggle" Constants.
-#define MAX_ROW 5
-#define MAX_COL 5
-#define SQUARE_COUNT 25
-#define NEIGHBOURS 8
-#define NUMBER_OF_ENGLISH_LETTERS 26
-#define SIZE_OF_CHARACTER_SET 14
-#define MAX_STRING_LENGTH 15
-#define BOGUS 4294967197
-
-// Constants that are lexicon specific.
-#define TOTAL_WORDS_IN_LEXICON 44220
-
-//               3          2         1
-//              1098 7654 3210 9876 5432 1098 7654 3210
-// child_index:                      111 1111 1111 1111
-// offset_index:       11 1111 1111 1000 0000 0000 0000
-// end_of_word:       100 0000 0000 0000 0000 0000 0000
-// blank:       1111 1
-
-struct Node {
-  // this is the index of the first child of this node (zero for leaf)
-  unsigned int child_index : 15;  // bits 0-14
-  // this is an index into the child offsets array
-  unsigned int offset_index : 11;  // bits 15-25
-  unsigned int is_word : 1;        // bit 26
-  int blank : 5;
-};
+using namespace std;
 
-// Constants that define the high level algorithm.
-#define NUMBER_OF_WORKER_THREADS 1
+// Constants that define the high level algorithm.  Zero worker threads means one per
+// core; this can be overridden with -t on the command line.
+#define NUMBER_OF_WORKER_THREADS 0
+// Workers claim boards from the shared list in chunks of this size.
+#define BOARDS_PER_CHUNK 1024
+// In streaming mode, boards move from the reader to the scorers in batches of this
+// size, and at most BATCHES_PER_THREAD batches per scorer thread are ever allocated.
+#define BOARDS_PER_BATCH 1024
+#define BATCHES_PER_THREAD 4
+// The benchmark (-b) scores the boards this many times with each strategy and reports
+// the fastest run, to smooth out noise from the rest of the machine.
+#define BENCHMARK_ROUNDS 5
 
 uint32_t SCORES[MAX_STRING_LENGTH + 1] = {
     0, 0, 0, 1, 1, 2, 3, 5, 11, 11, 11, 11, 11, 11, 11, 11
 };
 
-// These constant array's define the lexicon contained in the ADTDAWG.
-uint32_t CHARACTER_SET[SIZE_OF_CHARACTER_SET + 1] = {
-    'A', 'C', 'D', 'E', 'G', 'I', 'L', 'M', 'N', 'O', 'P', 'R', 'S', 'T', ' '
-};
-uint32_t CHARACTER_LOCATIONS[NUMBER_OF_ENGLISH_LETTERS] = {
-    0, BOGUS, 1,  2,     3,  BOGUS, 4,  BOGUS, 5,     BOGUS, BOGUS, 6,     7,
-    8, 9,     10, BOGUS, 11, 12,    13, BOGUS, BOGUS, BOGUS, BOGUS, BOGUS, BOGUS
-};
+// These array's define the lexicon contained in the ADTDAWG.  CHARACTER_LOCATIONS maps
+// each English letter to its index in the ADTDAWG's alphabet (BOGUS if it isn't in the
+// alphabet) and is filled in by UseDictionary.
+uint32_t CHARACTER_LOCATIONS[NUMBER_OF_ENGLISH_LETTERS];
+// JPA's Part Two encoding, which is hard-coded for the Lexicon_14 alphabet.
 uint64_t CHILD_MASKS[SIZE_OF_CHARACTER_SET] = {
     //    4         3         2         1
     // 32109876543210987654321098765432109876543210
@@ -86,24 +69,13 @@ uint32_t CHILD_SHIFTS[SIZE_OF_CHARACTER_SET] = {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // The structure for a Boggle board is defined in this section.
 
-// The "square" struct will represent one position in a Boggle board.
-// A square also requires a flag to indicate use in the current word being formed, the
-// number of valid neighbours, and the index of the letter showing on its face.
-struct Square {
-  // The Used flag will indicate if a square is being used in constructing the current
-  // word, and hence to remove the used square from further inclusion in the same word.
-  bool used;
-  uint32_t letter_idx;
-  uint32_t num_neighbors;
-  Square *neighbors[NEIGHBOURS];
-};
-
 // This Function initializes ThisSquare when passed its row and column position on the
 // board. Important note:  The function is going to use the low level C concept of
 // pointer arithmatic to fill the LivingNeighbourSquarePointerArray, which will be
 // filled from the top-left, clockwise.
 void SquareInit(Square *square, uint32_t row, uint32_t col) {
   square->letter_idx = SIZE_OF_CHARACTER_SET;
+  square->length = 1;
   square->used = false;
   for (int i = 0; i < NEIGHBOURS; i++) {
     (square->neighbors)[i] = NULL;
@@ -194,11 +166,6 @@ void SquareInit(Square *square, uint32_t row, uint32_t col) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// A board is defined as simply a static 2 dimensional array of Squares.
-struct Board {
-  Square Block[MAX_ROW][MAX_COL];
-};
-
 // This initialization function sets the neighbour array for all of the Squares in
 // ThisBoard's Block (this only needs to be done once). The Letter index for each square
 // will be a blank space ' ', and they will all be not Used.
@@ -219,256 +186,944 @@ void BoardInit(Board *ThisBoard) {
 void BoardPopulate(Board *bd, const char *letters) {
   for (uint32_t Row = MAX_ROW; Row-- > 0;) {
     for (uint32_t Col = MAX_COL; Col-- > 0;) {
-      (bd->Block)[Row][Col].letter_idx =
-          CHARACTER_LOCATIONS[letters[Row * MAX_COL + Col] - 'A'];
+      char letter = letters[Row * MAX_COL + Col];
+      (bd->Block)[Row][Col].letter_idx = CHARACTER_LOCATIONS[letter - 'A'];
+      (bd->Block)[Row][Col].length = letter == 'Q' ? 2 : 1;
     }
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// These are the global variables needed.
+// These are the global variables needed; see GunsOfNavarone.h.
+
+const Node *Nodes;
+const WideNode *WideNodes;
+const uint64_t *ChildOffsets;
+const uint32_t *Tracking;
+uint32_t NumWords;
+const uint32_t *PartTwoMasks;
+const NodeRecord<Node> *NodeRecords;
+const NodeRecord<WideNode> *WideNodeRecords;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The child index strategies that run on any CPU.
 
-// Each worker thread will have it's own time stamping uint32_t array for all of the
-// words in the lexicon.
-uint32_t *LexiconMarks;
+// JPA's encoding: a Part Two entry packs every letter's offset into 45 bits.
+struct TableStrategy {
+  typedef Node NodeType;
+  static const bool kNodeRecords = false;
+  static const Node &At(uint32_t idx) { return Nodes[idx]; }
+  static uint64_t Children(const Node &node) { return ChildOffsets[node.offset_index]; }
+  static uint64_t Offset(uint64_t children, uint32_t letter_idx) {
+    return (children & CHILD_MASKS[letter_idx]) >> CHILD_SHIFTS[letter_idx];
+  }
+};
+
+// Part Two read as a child mask: a letter's offset is the number of children before it.
+struct PopcountStrategy {
+  typedef Node NodeType;
+  static const bool kNodeRecords = false;
+  static const Node &At(uint32_t idx) { return Nodes[idx]; }
+  static uint32_t Children(const Node &node) { return PartTwoMasks[node.offset_index]; }
+  static uint32_t Offset(uint32_t children, uint32_t letter_idx) {
+    uint32_t bit = 1u << letter_idx;
+    return (children & bit) ? popcount(children & (bit - 1)) + 1 : 0;
+  }
+};
+
+// The child mask encoding: the same popcount, but the mask is in the node itself.
+struct ChildMaskStrategy {
+  typedef WideNode NodeType;
+  static const bool kNodeRecords = false;
+  static const WideNode &At(uint32_t idx) { return WideNodes[idx]; }
+  static uint32_t Children(const WideNode &node) { return node.child_mask; }
+  static uint32_t Offset(uint32_t children, uint32_t letter_idx) {
+    uint32_t bit = 1u << letter_idx;
+    return (children & bit) ? popcount(children & (bit - 1)) + 1 : 0;
+  }
+};
+
+// The same two strategies over the interleaved layout.
+struct TableRecordsStrategy : TableStrategy {
+  static const bool kNodeRecords = true;
+  static const NodeRecord<Node> &Record(uint32_t idx) { return NodeRecords[idx]; }
+  static const Node &At(uint32_t idx) { return NodeRecords[idx].node; }
+};
 
-// These are the pointers to the global immutable lexicon data structure.  The ADTDAWG
-// is well advanced and beyond the scope of the high level search algorithm. Since these
-// variables are branded as "Read Only," they can be utilized globally without passing
-// pointers.
-Node *Nodes;
-uint64_t *ChildOffsets;
-uint32_t *Tracking;
+struct ChildMaskRecordsStrategy : ChildMaskStrategy {
+  static const bool kNodeRecords = true;
+  static const NodeRecord<WideNode> &Record(uint32_t idx) {
+    return WideNodeRecords[idx];
+  }
+  static const WideNode &At(uint32_t idx) { return WideNodeRecords[idx].node; }
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// The sequential board scoring functions are found here for the new ADTDAWG.
-
-// This is the central piece of code in the BIG Boggle board analysis scheme.
-// Recursion is used to traverse the neighbours of the starting square, regardless of
-// alphabetical order. It updates the global "LexiconTimeStamps" to eliminate the
-// counting of identical words. Every letter on the board must be contained in the
-// lexicon character set.
-
-int ScoreSquare(
-    Square *square,
-    uint32_t node_idx,
-    uint32_t lexicon_idx,
-    uint32_t mark,
-    uint32_t num_chars
-) {
-  uint32_t score = 0;
-  square->used = true;
-  const auto &node = Nodes[node_idx];
+// Every scorer is listed here with what it needs to run.  For each encoding, the
+// scorers are in order of preference: SelectScorer picks the first one this CPU and
+// ADTDAWG can run, so the fastest variant measured with -b goes first.
+
+enum ScorerNeeds {
+  kNeedsPopcnt = 1,
+  kNeedsBmi2 = 2,
+};
+
+struct Scorer {
+  const char *name;
+  const char *layout;  // "arrays" for separate node and tracking arrays, or "records"
+  const char *isa;  // instructions beyond baseline x86-64, for reports
+  Encoding encoding;
+  uint32_t needs;
+  uint32_t (*score)(Worker *worker);
+};
+
+// On random10k.txt with one thread on a Xeon, the table and POPCNT are within noise of
+// each other and PEXT is ~20% slower: its 3 cycle latency costs more than the shift it
+// saves.  So the table stays the default for Part Two.  The interleaved records are
+// also within noise of the separate arrays: all of Lexicon_14 fits in L2 either way.
+const Scorer SCORERS[] = {
+    {"table", "arrays", "", kPartTwoEncoding, 0, ScoreBoardWith<TableStrategy>},
+    {"table",
+     "records",
+     "",
+     kPartTwoEncoding,
+     0,
+     ScoreBoardWith<TableRecordsStrategy>},
+#if defined(HAVE_X86_SCORERS)
+    {"popcount",
+     "arrays",
+     "popcnt",
+     kPartTwoEncoding,
+     kNeedsPopcnt,
+     ScoreBoardPopcountX86},
+    {"pext", "arrays", "bmi2", kPartTwoEncoding, kNeedsBmi2, ScoreBoardPextX86},
+#endif
+    {"popcount", "arrays", "", kPartTwoEncoding, 0, ScoreBoardWith<PopcountStrategy>},
+#if defined(HAVE_X86_SCORERS)
+    {"popcount",
+     "arrays",
+     "popcnt",
+     kChildMaskEncoding,
+     kNeedsPopcnt,
+     ScoreBoardChildMaskX86},
+    {"popcount",
+     "records",
+     "popcnt",
+     kChildMaskEncoding,
+     kNeedsPopcnt,
+     ScoreBoardChildMaskRecordsX86},
+#endif
+    {"popcount",
+     "arrays",
+     "",
+     kChildMaskEncoding,
+     0,
+     ScoreBoardWith<ChildMaskStrategy>},
+    {"popcount",
+     "records",
+     "",
+     kChildMaskEncoding,
+     0,
+     ScoreBoardWith<ChildMaskRecordsStrategy>},
+};
+const size_t NUMBER_OF_SCORERS = sizeof(SCORERS) / sizeof(SCORERS[0]);
+
+// Returns true if this CPU and the loaded ADTDAWG can run "scorer."
+bool ScorerAvailable(const Scorer &scorer, Encoding encoding) {
+  if (scorer.encoding != encoding) {
+    return false;
+  }
+#if defined(HAVE_X86_SCORERS)
+  if ((scorer.needs & kNeedsPopcnt) && !__builtin_cpu_supports("popcnt")) {
+    return false;
+  }
+  if ((scorer.needs & kNeedsBmi2) && !__builtin_cpu_supports("bmi2")) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+// Returns the preferred scorer with the given strategy name and layout (either may be
+// NULL for any) that can run here, or NULL if there is none.
+const Scorer *SelectScorer(Encoding encoding, const char *name, const char *layout) {
+  for (size_t i = 0; i < NUMBER_OF_SCORERS; i++) {
+    if (ScorerAvailable(SCORERS[i], encoding) &&
+        (!name || strcmp(SCORERS[i].name, name) == 0) &&
+        (!layout || strcmp(SCORERS[i].layout, layout) == 0)) {
+      return &SCORERS[i];
+    }
+  }
+  return NULL;
+}
+
+// Points at the selected scorer's function.
+uint32_t (*ScoreBoard)(Worker *worker);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The worker pool splits a list of boards across threads.  Each thread claims chunks of
+// BOARDS_PER_CHUNK boards from a shared counter and writes each score into the slot
+// matching the board's position, so the results come back in input order no matter
+// which thread scored them.
+
+// The number of times any worker has cleared its marks, added up as workers finish.
+atomic<uint64_t> MarkResets(0);
+
+void WorkerInit(Worker *worker) {
+  BoardInit(&worker->board);
+  worker->marks = (LexiconMark *)calloc(NumWords + 1, sizeof(LexiconMark));
+  worker->mark = 0;
+  worker->mark_resets = 0;
+}
+
+void WorkerFree(Worker *worker) {
+  MarkResets += worker->mark_resets;
+  free(worker->marks);
+}
+
+uint32_t NextMark(Worker *worker) {
+  if (worker->mark == MAX_LEXICON_MARK) {
+    memset(worker->marks, 0, (NumWords + 1) * sizeof(LexiconMark));
+    worker->mark = 0;
+    worker->mark_resets++;
+  }
+  return ++worker->mark;
+}
 
-  // Check if we have arrived at a new word, and if so, add the correct score
-  auto is_word = node.is_word;
-  if (is_word) {
-    if (LexiconMarks[lexicon_idx] < mark) {
-      score += SCORES[num_chars];
-      LexiconMarks[lexicon_idx] = mark;
+void ScoreBoardsWorker(
+    Worker *worker,
+    const vector<string> &boards,
+    vector<uint32_t> &scores,
+    atomic<size_t> &next_board
+) {
+  for (;;) {
+    size_t begin = next_board.fetch_add(BOARDS_PER_CHUNK);
+    if (begin >= boards.size()) {
+      break;
+    }
+    size_t end = min(begin + BOARDS_PER_CHUNK, boards.size());
+    for (size_t i = begin; i < end; i++) {
+      BoardPopulate(&worker->board, boards[i].c_str());
+      scores[i] = ScoreBoard(worker);
     }
   }
+}
+
+// Scores every board using "num_threads" workers and returns the scores in input order.
+vector<uint32_t> ScoreBoards(const vector<string> &boards, uint32_t num_threads) {
+  vector<uint32_t> scores(boards.size());
+  vector<Worker *> workers(num_threads);
+  vector<thread> threads;
+  atomic<size_t> next_board(0);
+
+  for (uint32_t i = 0; i < num_threads; i++) {
+    workers[i] = (Worker *)malloc(sizeof(Worker));
+    WorkerInit(workers[i]);
+  }
+  // The calling thread does its share of the work rather than sitting idle in join().
+  for (uint32_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(
+        ScoreBoardsWorker, workers[i], cref(boards), ref(scores), ref(next_board)
+    );
+  }
+  ScoreBoardsWorker(workers[0], boards, scores, next_board);
+  for (auto &t : threads) {
+    t.join();
+  }
 
-  // If this node has children in the lexicon, explore the neighbors
-  uint32_t child_idx = node.child_index;
-  if (child_idx) {
-    uint64_t child_offsets = ChildOffsets[node.offset_index];
+  for (auto worker : workers) {
+    WorkerFree(worker);
+    free(worker);
+  }
+  return scores;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Streaming mode pipelines reading and scoring so that memory use does not grow with
+// the input.  A reader thread parses and validates boards into batches and the scorer
+// threads consume them.  The batches cycle between two bounded queues: empty ones go
+// back to the reader through "free_batches," and filled ones go to the scorers through
+// "full_batches."  This supports pipes and files far larger than RAM.
+//
+// When per-board scores are wanted, scored batches go to a writer thread through
+// "scored_batches" instead, and it returns them to "free_batches" once they're written.
+//
+// SIGHUP reloads the ADTDAWG, so that a long-running stream picks up an image patched
+// with buildadtdawg -u.  The reader handles it before starting its next batch: it takes
+// every batch back from "free_batches," so no scorer or writer is still using the old
+// ADTDAWG, reloads, and hands them out again.  Scorers reallocate their marks when
+// they see a new DictionaryGeneration.
 
-    Square **neighbors = square->neighbors;
+struct BoardBatch {
+  uint64_t sequence;  // position of this batch in the input
+  uint32_t count;
+  char boards[BOARDS_PER_BATCH][SQUARE_COUNT];
+  uint32_t scores[BOARDS_PER_BATCH];
+};
+
+// Per-board scores are written in input order, either as one decimal line per board
+// or as a stream of fixed-width records: one native-endian uint32_t per board.
+struct ScoreOutput {
+  FILE *file;
+  bool binary;
+};
 
-    // Loop through all neighbors
-    for (int i = 0; i < square->num_neighbors; i++) {
-      auto n = neighbors[i];
-      if (n->used) {
-        continue;
+// Writes "count" scores.  Text is formatted by hand into one buffer per call, since a
+// printf per board would cost about as much as scoring it.
+void WriteScores(const ScoreOutput *output, const uint32_t *scores, size_t count) {
+  if (output->binary) {
+    fwrite(scores, sizeof(uint32_t), count, output->file);
+    return;
+  }
+  char buffer[BOARDS_PER_BATCH * 11];
+  while (count > 0) {
+    size_t n = min(count, (size_t)BOARDS_PER_BATCH);
+    char *p = buffer;
+    for (size_t i = 0; i < n; i++) {
+      char digits[10];
+      int len = 0;
+      uint32_t score = scores[i];
+      do {
+        digits[len++] = '0' + score % 10;
+        score /= 10;
+      } while (score);
+      while (len > 0) {
+        *p++ = digits[--len];
       }
-      auto letter_idx = n->letter_idx;
-      uint64_t offset64 = child_offsets & CHILD_MASKS[letter_idx];
+      *p++ = '\n';
+    }
+    fwrite(buffer, 1, p - buffer, output->file);
+    scores += n;
+    count -= n;
+  }
+}
+
+volatile sig_atomic_t ReloadRequested = 0;
+uint32_t DictionaryGeneration = 0;
+
+void RequestReload(int) { ReloadRequested = 1; }
 
-      if (offset64) {
-        offset64 >>= CHILD_SHIFTS[letter_idx];
-        uint32_t next_idx = child_idx + offset64 - 1;
+struct StreamStats {
+  uint64_t boards;
+  uint64_t invalid_boards;
+  uint64_t total_score;
+};
 
-        auto next_lexicon_idx =
-            lexicon_idx + Tracking[next_idx] - Tracking[child_idx] - is_word;
+// Reads the next whitespace-delimited token into "token" and returns its length.  At
+// most "max_len" characters are stored, but the whole token is always consumed.
+// Returns -1 at the end of the input.
+int ReadToken(FILE *input, char *token, int max_len) {
+  int c;
+  do {
+    c = getc_unlocked(input);
+  } while (c != EOF && isspace(c));
+  if (c == EOF) {
+    return -1;
+  }
+  int len = 0;
+  for (; c != EOF && !isspace(c); c = getc_unlocked(input)) {
+    if (len < max_len) {
+      token[len] = c;
+    }
+    len++;
+  }
+  return len;
+}
 
-        score += ScoreSquare(n, next_idx, next_lexicon_idx, mark, num_chars + 1);
+// A board is valid if it has exactly SQUARE_COUNT letters, all from the character set.
+// Valid boards are converted to upper case in place.
+bool ValidateBoard(char *board, int len) {
+  if (len != SQUARE_COUNT) {
+    return false;
+  }
+  for (int i = 0; i < SQUARE_COUNT; i++) {
+    char c = toupper(board[i]);
+    if (c < 'A' || c > 'Z' || CHARACTER_LOCATIONS[c - 'A'] == BOGUS) {
+      return false;
+    }
+  }
+  for (int i = 0; i < SQUARE_COUNT; i++) {
+    board[i] = toupper(board[i]);
+  }
+  return true;
+}
+
+// "reload" is called, with every batch idle, when SIGHUP has asked for a reload.
+void ReadBoardsWorker(
+    FILE *input,
+    uint32_t num_batches,
+    BoundedQueue<BoardBatch *> &free_batches,
+    BoundedQueue<BoardBatch *> &full_batches,
+    const function<void()> &reload,
+    StreamStats *stats
+) {
+  char token[SQUARE_COUNT + 1];
+  BoardBatch *batch = NULL;
+  uint64_t sequence = 0;
+  int len;
+  while ((len = ReadToken(input, token, SQUARE_COUNT)) >= 0) {
+    // The board is validated after the reload, since the alphabet may change.
+    if (!batch && ReloadRequested) {
+      ReloadRequested = 0;
+      vector<BoardBatch *> idle(num_batches);
+      for (auto &idle_batch : idle) {
+        free_batches.Pop(&idle_batch);
       }
+      reload();
+      for (auto idle_batch : idle) {
+        free_batches.Push(idle_batch);
+      }
+    }
+    if (!ValidateBoard(token, len)) {
+      token[min(len, SQUARE_COUNT)] = '\0';
+      fprintf(stderr, "Skipping invalid board '%s'\n", token);
+      stats->invalid_boards++;
+      continue;
+    }
+    if (!batch) {
+      free_batches.Pop(&batch);
+      batch->sequence = sequence++;
+      batch->count = 0;
     }
+    memcpy(batch->boards[batch->count++], token, SQUARE_COUNT);
+    stats->boards++;
+    if (batch->count == BOARDS_PER_BATCH) {
+      full_batches.Push(batch);
+      batch = NULL;
+    }
+  }
+  if (batch) {
+    full_batches.Push(batch);
   }
+  full_batches.Close();
+}
 
-  square->used = false;
-  return score;
+// "scored_batches" is NULL when per-board scores aren't being written.
+void ScoreBatchesWorker(
+    BoundedQueue<BoardBatch *> &free_batches,
+    BoundedQueue<BoardBatch *> &full_batches,
+    BoundedQueue<BoardBatch *> *scored_batches,
+    atomic<uint64_t> &total_score
+) {
+  Worker *worker = (Worker *)malloc(sizeof(Worker));
+  WorkerInit(worker);
+  uint32_t generation = DictionaryGeneration;
+  BoardBatch *batch;
+  uint64_t score = 0;
+  while (full_batches.Pop(&batch)) {
+    if (generation != DictionaryGeneration) {
+      WorkerFree(worker);
+      WorkerInit(worker);
+      generation = DictionaryGeneration;
+    }
+    for (uint32_t i = 0; i < batch->count; i++) {
+      BoardPopulate(&worker->board, batch->boards[i]);
+      batch->scores[i] = ScoreBoard(worker);
+      score += batch->scores[i];
+    }
+    if (scored_batches) {
+      scored_batches->Push(batch);
+    } else {
+      free_batches.Push(batch);
+    }
+  }
+  total_score += score;
+  WorkerFree(worker);
+  free(worker);
 }
 
-// The function returns the Boggle score for "ThisBoard."
-uint32_t ScoreBoard(Board *ThisBoard, uint32_t mark) {
-  auto &block = ThisBoard->Block;
-  uint32_t score = 0;
-  // Add up all the scores that originate from each square in the board.
-  for (uint32_t row = 0; row < MAX_ROW; row++) {
-    for (uint32_t col = 0; col < MAX_COL; col++) {
-      uint32_t part1_idx = block[row][col].letter_idx + 1;
-      score += ScoreSquare(&block[row][col], part1_idx, Tracking[part1_idx], mark, 1);
+// Scorers finish batches out of order, so each one is held until every earlier batch
+// has been written.
+void WriteBatchesWorker(
+    BoundedQueue<BoardBatch *> &scored_batches,
+    BoundedQueue<BoardBatch *> &free_batches,
+    const ScoreOutput *output
+) {
+  map<uint64_t, BoardBatch *> pending;
+  uint64_t next_sequence = 0;
+  BoardBatch *batch;
+  while (scored_batches.Pop(&batch)) {
+    pending[batch->sequence] = batch;
+    for (auto it = pending.begin(); it != pending.end() && it->first == next_sequence;
+         it = pending.erase(it)) {
+      WriteScores(output, it->second->scores, it->second->count);
+      free_batches.Push(it->second);
+      next_sequence++;
     }
   }
-  return score;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scores every board in "input" using "num_threads" scorer threads plus the calling
+// thread as the reader.  If "output" isn't NULL, each board's score is written to it
+// in input order by one more thread.  "reload" swaps in a new ADTDAWG on SIGHUP.
+StreamStats ScoreStream(
+    FILE *input,
+    uint32_t num_threads,
+    const ScoreOutput *output,
+    const function<void()> &reload
+) {
+  uint32_t num_batches = num_threads * BATCHES_PER_THREAD;
+  vector<BoardBatch> batches(num_batches);
+  BoundedQueue<BoardBatch *> free_batches(num_batches);
+  BoundedQueue<BoardBatch *> full_batches(num_batches);
+  BoundedQueue<BoardBatch *> scored_batches(num_batches);
+  for (auto &batch : batches) {
+    free_batches.Push(&batch);
+  }
 
-int LoadDictionary() {
-  FILE *PartOne = fopen(FOUR_PART_DTDAWG_14_PART_ONE, "rb");
-  FILE *PartTwo = fopen(FOUR_PART_DTDAWG_14_PART_TWO, "rb");
-  FILE *PartThree = fopen(FOUR_PART_DTDAWG_14_PART_THREE, "rb");
-  FILE *PartFour = fopen(FOUR_PART_DTDAWG_14_PART_FOUR, "rb");
-
-  unsigned char TempReadIn;
-  uint32_t SizeOfPartOne;
-  uint64_t SizeOfPartTwo;
-  uint32_t SizeOfPartThree;
-
-  // Read in the size of each data file.
-  if (fread(&SizeOfPartOne, 4, 1, PartOne) != 1) return 0;
-  if (fread(&SizeOfPartTwo, 8, 1, PartTwo) != 1) return 0;
-  if (fread(&SizeOfPartThree, 4, 1, PartThree) != 1) return 0;
-
-  // Allocate memory for the ADTDAWG.
-  size_t bytes_one = (SizeOfPartOne + 1) * sizeof(uint32_t);
-  size_t bytes_two = SizeOfPartTwo * sizeof(uint64_t);
-  size_t bytes_three = (SizeOfPartOne + 1) * sizeof(uint32_t);
-  Nodes = (Node *)malloc(bytes_one);
-  ChildOffsets = (uint64_t *)malloc(bytes_two);
-  Tracking = (uint32_t *)malloc(bytes_three);
-
-  printf(
-      "bytes for arrays: %zu + %zu + %zu = %zu\n",
-      bytes_one,
-      bytes_two,
-      bytes_three,
-      bytes_one + bytes_two + bytes_three
-  );
+  StreamStats stats = {0, 0, 0};
+  atomic<uint64_t> total_score(0);
+  vector<thread> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(
+        ScoreBatchesWorker,
+        ref(free_batches),
+        ref(full_batches),
+        output ? &scored_batches : NULL,
+        ref(total_score)
+    );
+  }
+  thread writer;
+  if (output) {
+    writer = thread(WriteBatchesWorker, ref(scored_batches), ref(free_batches), output);
+  }
+  ReadBoardsWorker(input, num_batches, free_batches, full_batches, reload, &stats);
+  for (auto &t : threads) {
+    t.join();
+  }
+  if (output) {
+    scored_batches.Close();
+    writer.join();
+  }
+  stats.total_score = total_score;
+  return stats;
+}
 
-  // Read in the data files into global arrays of basic integer types.
-  // The zero position in "PartOneArray" is the NULL node.
-  Nodes[0].child_index = 0;
-  Nodes[0].is_word = 0;
-  Nodes[0].offset_index = 0;
-  if (fread(Nodes + 1, 4, SizeOfPartOne, PartOne) != SizeOfPartOne) return 0;
-  if (fread(ChildOffsets, 8, SizeOfPartTwo, PartTwo) != SizeOfPartTwo) return 0;
-  // The Zero position in "PartThreeArray" maps to the NULL node in "PartOneArray".
-  Tracking[0] = 0;
-  if (fread(Tracking + 1, 4, SizeOfPartThree, PartThree) != SizeOfPartThree) return 0;
-  // Part Four has been replaced by encoding the Part Four WTEOBL values as 32 bit
-  // integers for speed.  The size of the data structure is small enough as it is.
-  for (int X = (SizeOfPartThree + 1); X <= SizeOfPartOne; X++) {
-    if (fread(&TempReadIn, 1, 1, PartFour) != 1) return 0;
-    Tracking[X] = TempReadIn;
-  }
-
-  fclose(PartOne);
-  fclose(PartTwo);
-  fclose(PartThree);
-  fclose(PartFour);
-  return 1;
+// Copies "nodes" and the tracking numbers into the interleaved layout.
+template <typename NodeType>
+void BuildNodeRecords(
+    const NodeType *nodes, uint32_t num_nodes, vector<NodeRecord<NodeType>> *records
+) {
+  records->assign(num_nodes + 1, {});
+  for (uint32_t i = 1; i <= num_nodes; i++) {
+    auto &record = (*records)[i];
+    record.node = nodes[i];
+    record.tracking = Tracking[i];
+    record.child_delta = Tracking[nodes[i].child_index] + nodes[i].is_word;
+  }
+}
+
+// Loads the ADTDAWG, either by mapping "image_file" or, when that is NULL, by reading
+// the four-part .dat files.  Returns NULL if it can't be loaded or scored here.
+unique_ptr<Adtdawg> LoadDictionary(const char *image_file) {
+  unique_ptr<Adtdawg> dawg;
+  if (image_file) {
+    dawg = Adtdawg::MapImage(image_file);
+  } else {
+    dawg = Adtdawg::LoadFourPart(
+        FOUR_PART_DTDAWG_14_PART_ONE,
+        FOUR_PART_DTDAWG_14_PART_TWO,
+        FOUR_PART_DTDAWG_14_PART_THREE,
+        FOUR_PART_DTDAWG_14_PART_FOUR,
+        LEXICON_14_ALPHABET
+    );
+  }
+  if (!dawg.get()) {
+    return NULL;
+  }
+  if (dawg->GetEncoding() == kPartTwoEncoding) {
+    // CHILD_MASKS and CHILD_SHIFTS are only correct for this alphabet.
+    if (dawg->Alphabet() != LEXICON_14_ALPHABET) {
+      fprintf(stderr, "Expected an ADTDAWG over %s\n", LEXICON_14_ALPHABET);
+      return NULL;
+    }
+  }
+  return dawg;
+}
+
+// Points the scorers' globals at "dawg."
+void UseDictionary(const Adtdawg &dawg) {
+  const string &alphabet = dawg.Alphabet();
+  for (int i = 0; i < NUMBER_OF_ENGLISH_LETTERS; i++) {
+    CHARACTER_LOCATIONS[i] = BOGUS;
+  }
+  for (size_t i = 0; i < alphabet.size(); i++) {
+    CHARACTER_LOCATIONS[alphabet[i] - 'A'] = i;
+  }
+
+  Nodes = dawg.Nodes();
+  WideNodes = dawg.WideNodes();
+  ChildOffsets = dawg.ChildOffsets();
+  Tracking = dawg.Tracking();
+  PartTwoMasks = dawg.PartTwoMasks();
+  NumWords = dawg.NumWords();
+  // UseScorer builds the interleaved layout again for these nodes if it's needed.
+  NodeRecords = NULL;
+  WideNodeRecords = NULL;
+}
+
+// Points ScoreBoard at "scorer."  The interleaved layout is a copy of Part One and the
+// tracking numbers, so it is only built, once, for a scorer that reads it; the others
+// use the ADTDAWG's arrays in place.
+void UseScorer(const Scorer &scorer, const Adtdawg &dawg) {
+  static vector<NodeRecord<Node>> node_records;
+  static vector<NodeRecord<WideNode>> wide_node_records;
+  if (strcmp(scorer.layout, "records") == 0) {
+    if (dawg.GetEncoding() == kPartTwoEncoding && !NodeRecords) {
+      BuildNodeRecords(Nodes, dawg.NumNodes(), &node_records);
+      NodeRecords = node_records.data();
+    } else if (dawg.GetEncoding() == kChildMaskEncoding && !WideNodeRecords) {
+      BuildNodeRecords(WideNodes, dawg.NumNodes(), &wide_node_records);
+      WideNodeRecords = wide_node_records.data();
+    }
+  }
+  ScoreBoard = scorer.score;
+}
+
+// Loads the ADTDAWG again and switches "scorer" to it.  Only safe while no board is
+// being scored.  If the new ADTDAWG can't be loaded, or has an encoding "scorer" can't
+// run, the current one stays in use.
+void ReloadDictionary(
+    const char *image_file, const Scorer &scorer, unique_ptr<Adtdawg> *dawg
+) {
+  auto reloaded = LoadDictionary(image_file);
+  if (reloaded.get() && reloaded->GetEncoding() != scorer.encoding) {
+    fprintf(stderr, "The new ADTDAWG has a different encoding\n");
+    reloaded.reset();
+  }
+  if (!reloaded.get()) {
+    fprintf(stderr, "Keeping the current ADTDAWG\n");
+    return;
+  }
+  UseDictionary(*reloaded);
+  UseScorer(scorer, *reloaded);
+  *dawg = move(reloaded);
+  DictionaryGeneration++;
+  fprintf(stderr, "Reloaded the ADTDAWG: %u words\n", NumWords);
+}
+
+// Scores "boards" with every scorer that can run here and reports how fast each one
+// is.  Returns false if they don't all agree on the total score.
+bool RunBenchmark(
+    const vector<string> &boards, const Adtdawg &dawg, uint32_t num_threads
+) {
+  bool agree = true;
+  uint64_t expected_total = 0;
+  bool first = true;
+  for (size_t i = 0; i < NUMBER_OF_SCORERS; i++) {
+    const Scorer &scorer = SCORERS[i];
+    if (!ScorerAvailable(scorer, dawg.GetEncoding())) {
+      continue;
+    }
+    UseScorer(scorer, dawg);
+    vector<uint32_t> scores;
+    double TheRunTime = 0;
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+      auto BeginWorkTime = chrono::steady_clock::now();
+      scores = ScoreBoards(boards, num_threads);
+      auto EndWorkTime = chrono::steady_clock::now();
+      double run_time = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
+      if (round == 0 || run_time < TheRunTime) {
+        TheRunTime = run_time;
+      }
+    }
+
+    uint64_t total_score = 0;
+    for (auto score : scores) {
+      total_score += score;
+    }
+    if (first) {
+      expected_total = total_score;
+      first = false;
+    }
+    printf(
+        "%-10s %-8s %-8s %.3f seconds, %.2f boards/second, total score %llu%s\n",
+        scorer.name,
+        scorer.layout,
+        scorer.isa[0] ? scorer.isa : "baseline",
+        TheRunTime,
+        boards.size() / TheRunTime,
+        (unsigned long long)total_score,
+        total_score == expected_total ? "" : " MISMATCH"
+    );
+    agree = agree && total_score == expected_total;
+  }
+  return agree;
+}
+
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [-t threads] [-i image_file] [-c strategy] [-l layout] [-s | -b] "
+      "[-o score_file [-f format]] <board_file>\n",
+      program
+  );
+  fprintf(stderr, "  -c picks the child index strategy: table, popcount or pext.\n");
+  fprintf(stderr, "  -l picks the node layout: arrays or records.\n");
+  fprintf(stderr, "  -b benchmarks every strategy this CPU can run.\n");
+  fprintf(stderr, "  -s streams boards instead of reading them all up front.  SIGHUP\n");
+  fprintf(stderr, "     then reloads the ADTDAWG before the next batch.\n");
+  fprintf(stderr, "  -o writes each board's score, in input order, to a file (- for\n");
+  fprintf(stderr, "     stdout).  -f picks its format: text (default) or binary.\n");
+  fprintf(stderr, "  A board_file of - reads from stdin (implies -s).\n");
 }
 
 int main(int argc, char *argv[]) {
-  uint32_t X;
-  uint32_t CurrentScore;
   uint32_t BoardCount = 0;
+  uint32_t num_threads = NUMBER_OF_WORKER_THREADS;
+  const char *image_file = NULL;
+  const char *strategy = NULL;
+  const char *layout = NULL;
+  bool streaming = false;
+  bool benchmark = false;
+  const char *score_file = NULL;
+  ScoreOutput output = {NULL, false};
 
   char BoardString[SQUARE_COUNT + 1];
-  Board *WorkingBoard = (Board *)malloc(sizeof(Board));
-
-  double BeginWorkTime;
-  double EndWorkTime;
-  double TheRunTime;
 
   FILE *input_file;
 
+  int opt;
+  while ((opt = getopt(argc, argv, "t:i:c:l:sbo:f:")) != -1) {
+    switch (opt) {
+      case 't':
+        if (!ParseCount(optarg, 0, kMaxThreads, &num_threads)) {
+          fprintf(stderr, "Bad value for -t: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'i':
+        image_file = optarg;
+        break;
+      case 'c':
+        strategy = optarg;
+        break;
+      case 'l':
+        layout = optarg;
+        break;
+      case 's':
+        streaming = true;
+        break;
+      case 'b':
+        benchmark = true;
+        break;
+      case 'o':
+        score_file = optarg;
+        break;
+      case 'f':
+        if (strcmp(optarg, "binary") == 0) {
+          output.binary = true;
+        } else if (strcmp(optarg, "text") != 0) {
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+
   // Check for command-line argument
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s <board_file>\n", argv[0]);
+  if (argc - optind != 1 || (benchmark && (streaming || score_file))) {
+    PrintUsage(argv[0]);
     return 1;
   }
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
 
-  BoardInit(WorkingBoard);
+  // With scores going to stdout, the summary goes to stderr instead.
+  FILE *report = stdout;
+  if (score_file) {
+    if (strcmp(score_file, "-") == 0) {
+      output.file = stdout;
+      report = stderr;
+    } else {
+      output.file = fopen(score_file, output.binary ? "wb" : "w");
+    }
+    if (!output.file) {
+      fprintf(stderr, "Error: Could not open file %s\n", score_file);
+      return 1;
+    }
+    // Writes happen in large blocks already; this just avoids a second copy.
+    setvbuf(output.file, NULL, _IOFBF, 1 << 20);
+  }
 
-  // Allocate the set of lexicon time stamps as uint32_tegers.
-  size_t bytes_marks = (TOTAL_WORDS_IN_LEXICON + 1) * sizeof(uint32_t);
-  LexiconMarks = (uint32_t *)malloc(bytes_marks);
-  printf("bytes for marks: %zu\n", bytes_marks);
-  printf("sizeof(Node): %zu\n", sizeof(Node));
+  auto dawg = LoadDictionary(image_file);
+  if (!dawg.get()) {
+    return 1;
+  }
+  UseDictionary(*dawg);
+  const Scorer *scorer = SelectScorer(dawg->GetEncoding(), strategy, layout);
+  if (!scorer) {
+    fprintf(
+        stderr,
+        "No %s strategy with the %s layout can run on this CPU and ADTDAWG\n",
+        strategy ? strategy : "child index",
+        layout ? layout : "requested"
+    );
+    return 1;
+  }
+  if (!benchmark) {
+    UseScorer(*scorer, *dawg);
+    fprintf(
+        stderr,
+        "Child index strategy: %s (%s, %s)\n",
+        scorer->name,
+        scorer->layout,
+        scorer->isa[0] ? scorer->isa : "baseline"
+    );
+  }
 
-  // Zero all of the global time stamps.
-  memset(LexiconMarks, 0, (TOTAL_WORDS_IN_LEXICON + 1) * sizeof(uint32_t));
+  // Each worker allocates its own set of lexicon time stamps as LexiconMarks.
+  size_t bytes_marks = (NumWords + 1) * sizeof(LexiconMark);
+  fprintf(report, "bytes for marks: %zu\n", bytes_marks);
+  fprintf(report, "sizeof(Node): %zu\n", dawg->NodeBytes());
 
-  int result = LoadDictionary();
-  if (result != 1) {
-    return result;
-  }
+  size_t bytes_one = (dawg->NumNodes() + 1) * dawg->NodeBytes();
+  size_t bytes_two = dawg->NumChildOffsets() * sizeof(uint64_t);
+  size_t bytes_three = (dawg->NumNodes() + 1) * sizeof(uint32_t);
+  fprintf(
+      report,
+      "bytes for arrays: %zu + %zu + %zu = %zu\n",
+      bytes_one,
+      bytes_two,
+      bytes_three,
+      bytes_one + bytes_two + bytes_three
+  );
 
   // Open the input file
-  input_file = fopen(argv[1], "r");
+  if (strcmp(argv[optind], "-") == 0 && !benchmark) {
+    input_file = stdin;
+    streaming = true;
+  } else {
+    input_file = fopen(argv[optind], "r");
+  }
   if (input_file == NULL) {
-    fprintf(stderr, "Error: Could not open file %s\n", argv[1]);
+    fprintf(stderr, "Error: Could not open file %s\n", argv[optind]);
     return 1;
   }
 
-  for (int i = 0; i < 100; i++) {
-    auto c = ChildOffsets[i];
-    printf("%d: %llu\n", i, c);
-    for (int j = 0; j < SIZE_OF_CHARACTER_SET; j++) {
-      printf(" %2llu", (c & CHILD_MASKS[j]) >> CHILD_SHIFTS[j]);
+  if (streaming) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = RequestReload;
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGHUP, &action, NULL);
+
+    auto BeginWorkTime = chrono::steady_clock::now();
+    auto stats = ScoreStream(
+        input_file,
+        num_threads,
+        score_file ? &output : NULL,
+        [&]() { ReloadDictionary(image_file, *scorer, &dawg); }
+    );
+    auto EndWorkTime = chrono::steady_clock::now();
+    double TheRunTime = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
+    if (input_file != stdin) {
+      fclose(input_file);
+    }
+    if (score_file && fclose(output.file) != 0) {
+      fprintf(stderr, "Error: Could not write %s\n", score_file);
+      return 1;
+    }
+
+    fprintf(
+        report,
+        "Evaluated %llu boards\nTotal score: %llu\n",
+        (unsigned long long)stats.boards,
+        (unsigned long long)stats.total_score
+    );
+    if (stats.invalid_boards) {
+      fprintf(
+          report,
+          "Skipped %llu invalid boards\n",
+          (unsigned long long)stats.invalid_boards
+      );
     }
-    printf("\n");
+    fprintf(
+        stderr,
+        "Streamed %llu boards in %.3f seconds with %u threads (%.2f boards/second)\n",
+        (unsigned long long)stats.boards,
+        TheRunTime,
+        num_threads,
+        stats.boards / TheRunTime
+    );
+    fprintf(
+        stderr, "Cleared lexicon marks %llu times\n", (unsigned long long)MarkResets
+    );
+    return 0;
   }
 
   // Read the boards in advance to avoid measuring I/O time.
   vector<string> boards;
 
-  BeginWorkTime = (double)clock() / CLOCKS_PER_SEC;
+  // clock() adds up CPU time across threads, so measure wall time instead.
+  auto BeginWorkTime = chrono::steady_clock::now();
 
-  // Read boards from file and score them
-  while (fscanf(input_file, "%25s", BoardString) == 1) {
-    BoardString[SQUARE_COUNT] = '\0';
-    for (int i = 0; BoardString[i]; i++) {
-      BoardString[i] = toupper(BoardString[i]);
+  // Read boards from file and score them.  Invalid boards are skipped, as when
+  // streaming.
+  uint64_t invalid_boards = 0;
+  int len;
+  while ((len = ReadToken(input_file, BoardString, SQUARE_COUNT)) >= 0) {
+    if (!ValidateBoard(BoardString, len)) {
+      BoardString[min(len, SQUARE_COUNT)] = '\0';
+      fprintf(stderr, "Skipping invalid board '%s'\n", BoardString);
+      invalid_boards++;
+      continue;
     }
+    BoardString[SQUARE_COUNT] = '\0';
     boards.push_back(BoardString);
   }
   fclose(input_file);
 
+  if (benchmark) {
+    return RunBenchmark(boards, *dawg, num_threads) ? 0 : 1;
+  }
+
+  auto scores = ScoreBoards(boards, num_threads);
   uint32_t total_score = 0;
-  for (const auto &board : boards) {
-    BoardPopulate(WorkingBoard, board.c_str());
-    CurrentScore = ScoreBoard(WorkingBoard, BoardCount + 1);
-    total_score += CurrentScore;
+  for (auto score : scores) {
+    total_score += score;
     BoardCount++;
   }
 
-  EndWorkTime = (double)clock() / CLOCKS_PER_SEC;
-  TheRunTime = EndWorkTime - BeginWorkTime;
+  auto EndWorkTime = chrono::steady_clock::now();
+  double TheRunTime = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
 
-  printf("Evaluated %zu boards\nTotal score: %u\n", boards.size(), total_score);
+  // Scoring has finished by now, so there is nothing for a writer thread to overlap.
+  if (score_file) {
+    WriteScores(&output, scores.data(), scores.size());
+    if (fclose(output.file) != 0) {
+      fprintf(stderr, "Error: Could not write %s\n", score_file);
+      return 1;
+    }
+  }
+
+  fprintf(
+      report, "Evaluated %zu boards\nTotal score: %u\n", boards.size(), total_score
+  );
+  if (invalid_boards) {
+    fprintf(
+        report, "Skipped %llu invalid boards\n", (unsigned long long)invalid_boards
+    );
+  }
   // printf("sizeof(long int) = %zu\n", sizeof(long int));  // 8
 
   // Report performance to stderr
   fprintf(
       stderr,
-      "Scored %u boards in %.3f seconds (%.2f boards/second)\n",
+      "Scored %u boards in %.3f seconds with %u threads (%.2f boards/second)\n",
       BoardCount,
       TheRunTime,
+      num_threads,
       BoardCount / TheRunTime
   );
-
-  // Clean up
-  free(WorkingBoard);
-  free(LexiconMarks);
-  free(Nodes);
-  free(ChildOffsets);
-  free(Tracking);
+  fprintf(stderr, "Cleared lexicon marks %llu times\n", (unsigned long long)MarkResets);
 
   return 0;
 }
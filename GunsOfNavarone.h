@@ -0,0 +1,225 @@
+// The board representation and recursive scorer shared by GunsOfNavarone.cc and the
+// CPU-specific scorers in GunsOfNavarone_x86.cc.
+#ifndef GUNS_OF_NAVARONE_H
+#define GUNS_OF_NAVARONE_H
+
+#include <stdint.h>
+
+#include "adtdawg.h"
+
+// General "Boggle" Constants.
+#define MAX_ROW 5
+#define MAX_COL 5
+#define SQUARE_COUNT 25
+#define NEIGHBOURS 8
+#define NUMBER_OF_ENGLISH_LETTERS 26
+#define SIZE_OF_CHARACTER_SET 14
+#define MAX_STRING_LENGTH 15
+#define BOGUS 4294967197
+
+// Bits per lexicon mark.  With 16 bits each worker's marks take half the cache, at the
+// cost of clearing them every MAX_LEXICON_MARK boards.  Build with
+// -DLEXICON_MARK_BITS=32 to go back to 32-bit marks, which never need clearing.
+#ifndef LEXICON_MARK_BITS
+#define LEXICON_MARK_BITS 16
+#endif
+#if LEXICON_MARK_BITS == 16
+typedef uint16_t LexiconMark;
+#define MAX_LEXICON_MARK 65535
+#else
+typedef uint32_t LexiconMark;
+#define MAX_LEXICON_MARK 4294967295
+#endif
+
+extern uint32_t SCORES[MAX_STRING_LENGTH + 1];
+extern uint32_t CHARACTER_LOCATIONS[NUMBER_OF_ENGLISH_LETTERS];
+extern uint64_t CHILD_MASKS[SIZE_OF_CHARACTER_SET];
+extern uint32_t CHILD_SHIFTS[SIZE_OF_CHARACTER_SET];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The structure for a Boggle board is defined in this section.
+
+// The "square" struct will represent one position in a Boggle board.
+// A square also requires a flag to indicate use in the current word being formed, the
+// number of valid neighbours, and the index of the letter showing on its face.
+struct Square {
+  // The Used flag will indicate if a square is being used in constructing the current
+  // word, and hence to remove the used square from further inclusion in the same word.
+  bool used;
+  uint32_t letter_idx;
+  // The number of letters the square contributes to a word: 2 for "Qu," 1 otherwise.
+  uint32_t length;
+  uint32_t num_neighbors;
+  Square *neighbors[NEIGHBOURS];
+};
+
+// A board is defined as simply a static 2 dimensional array of Squares.
+struct Board {
+  Square Block[MAX_ROW][MAX_COL];
+};
+
+// The interleaved node layout: each record holds a node together with its own tracking
+// number and a precomputed word index delta for its children.  A child's word index is
+// then the parent's index - child_delta + the child's tracking, so descending to a
+// child needs one load instead of a node and two tracking numbers.  (Parents can point
+// into the middle of a shared child list, so the delta has to belong to the parent.)
+template <typename NodeType>
+struct NodeRecord {
+  NodeType node;
+  uint32_t tracking;     // Tracking[idx]
+  uint32_t child_delta;  // Tracking[node.child_index] + node.is_word
+};
+
+// Each worker thread will have it's own Board and time stamping LexiconMark array for
+// all of the words in the lexicon.  The mark is bumped once per board scored, and the
+// marks are cleared whenever it would pass MAX_LEXICON_MARK.
+struct Worker {
+  Board board;
+  LexiconMark *marks;
+  uint32_t mark;
+  uint64_t mark_resets;
+};
+
+// Returns the mark for the next board, clearing the worker's marks first if they have
+// run out.
+uint32_t NextMark(Worker *worker);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// These are the global variables needed.
+
+// These are the pointers to the global immutable lexicon data structure.  The ADTDAWG
+// is well advanced and beyond the scope of the high level search algorithm. Since these
+// variables are branded as "Read Only," they can be utilized globally without passing
+// pointers.  They point into either a read-only mapping of an image file or the
+// four-part .dat files loaded into memory.  Only one of Nodes and WideNodes is set,
+// depending on the ADTDAWG's encoding.
+extern const Node *Nodes;
+extern const WideNode *WideNodes;
+extern const uint64_t *ChildOffsets;
+extern const uint32_t *Tracking;
+extern uint32_t NumWords;
+// For the Part Two encoding, bit i of PartTwoMasks[offset_index] is set when the Part
+// Two entry has a child for the i'th letter.  These are the ADTDAWG's own masks.
+extern const uint32_t *PartTwoMasks;
+// The same nodes as Nodes or WideNodes in the interleaved layout.
+extern const NodeRecord<Node> *NodeRecords;
+extern const NodeRecord<WideNode> *WideNodeRecords;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The sequential board scoring functions are found here for the new ADTDAWG.
+//
+// Each child index strategy supplies its node type, the "children" of a node (looked up
+// once per node), and the 1-based offset of a letter's child within them (zero when the
+// letter has no child).  A strategy is a compile-time policy, so every ScoreSquare
+// instance is specialized for exactly one of them.  Strategies with kNodeRecords set
+// read the interleaved layout and also supply Record(idx).
+
+// This is the central piece of code in the BIG Boggle board analysis scheme.
+// Recursion is used to traverse the neighbours of the starting square, regardless of
+// alphabetical order. It updates the worker's "marks" to eliminate the counting of
+// identical words. Every letter on the board must be contained in the
+// lexicon character set.
+
+template <typename Strategy>
+int ScoreSquare(
+    LexiconMark *marks,
+    Square *square,
+    uint32_t node_idx,
+    uint32_t lexicon_idx,
+    uint32_t mark,
+    uint32_t num_chars
+) {
+  uint32_t score = 0;
+  square->used = true;
+  const auto &node = Strategy::At(node_idx);
+
+  // Check if we have arrived at a new word, and if so, add the correct score
+  auto is_word = node.is_word;
+  if (is_word) {
+    if (marks[lexicon_idx] < mark) {
+      score += SCORES[num_chars];
+      marks[lexicon_idx] = mark;
+    }
+  }
+
+  // If this node has children in the lexicon, explore the neighbors
+  uint32_t child_idx = node.child_index;
+  if (child_idx) {
+    auto children = Strategy::Children(node);
+    uint32_t base_lexicon_idx;
+    if constexpr (Strategy::kNodeRecords) {
+      base_lexicon_idx = lexicon_idx - Strategy::Record(node_idx).child_delta;
+    }
+
+    Square **neighbors = square->neighbors;
+
+    // Loop through all neighbors
+    for (int i = 0; i < square->num_neighbors; i++) {
+      auto n = neighbors[i];
+      if (n->used) {
+        continue;
+      }
+      auto offset = Strategy::Offset(children, n->letter_idx);
+
+      if (offset) {
+        uint32_t next_idx = child_idx + offset - 1;
+
+        uint32_t next_lexicon_idx;
+        if constexpr (Strategy::kNodeRecords) {
+          next_lexicon_idx = base_lexicon_idx + Strategy::Record(next_idx).tracking;
+        } else {
+          next_lexicon_idx =
+              lexicon_idx + Tracking[next_idx] - Tracking[child_idx] - is_word;
+        }
+
+        score += ScoreSquare<Strategy>(
+            marks, n, next_idx, next_lexicon_idx, mark, num_chars + n->length
+        );
+      }
+    }
+  }
+
+  square->used = false;
+  return score;
+}
+
+// The function returns the Boggle score for the board currently populated in "worker."
+template <typename Strategy>
+uint32_t ScoreBoardWith(Worker *worker) {
+  auto &block = worker->board.Block;
+  uint32_t mark = NextMark(worker);
+  uint32_t score = 0;
+  // Add up all the scores that originate from each square in the board.
+  for (uint32_t row = 0; row < MAX_ROW; row++) {
+    for (uint32_t col = 0; col < MAX_COL; col++) {
+      auto &square = block[row][col];
+      uint32_t part1_idx = square.letter_idx + 1;
+      uint32_t lexicon_idx;
+      if constexpr (Strategy::kNodeRecords) {
+        lexicon_idx = Strategy::Record(part1_idx).tracking;
+      } else {
+        lexicon_idx = Tracking[part1_idx];
+      }
+      score += ScoreSquare<Strategy>(
+          worker->marks, &square, part1_idx, lexicon_idx, mark, square.length
+      );
+    }
+  }
+  return score;
+}
+
+// Scorers built with x86 instructions beyond the baseline (see GunsOfNavarone_x86.cc).
+// Only call these after checking the CPU supports the instructions they need.
+#if defined(__x86_64__)
+#define HAVE_X86_SCORERS 1
+// Part Two, popcount over PartTwoMasks.  Needs POPCNT.
+uint32_t ScoreBoardPopcountX86(Worker *worker);
+// Part Two, _pext_u64 over the Part Two entry.  Needs BMI2.
+uint32_t ScoreBoardPextX86(Worker *worker);
+// Child mask encoding, popcount over the node's mask.  Needs POPCNT.
+uint32_t ScoreBoardChildMaskX86(Worker *worker);
+// The same over WideNodeRecords.  Needs POPCNT.
+uint32_t ScoreBoardChildMaskRecordsX86(Worker *worker);
+#endif
+
+#endif  // GUNS_OF_NAVARONE_H
@@ -0,0 +1,76 @@
+// Scorers that use POPCNT and BMI2.  The Makefile builds only this file with -mpopcnt
+// and -mbmi2, and GunsOfNavarone only calls into it after checking the CPU, so the
+// rest of the program still runs on any x86-64.
+//
+// The strategies live in an anonymous namespace so that every ScoreSquare instance
+// built here has internal linkage.  Sharing an inline function with GunsOfNavarone.cc
+// would let the linker pick this file's copy for the baseline scorers too.
+#include "GunsOfNavarone.h"
+
+#if defined(HAVE_X86_SCORERS)
+
+#include <immintrin.h>
+
+namespace {
+
+// Part Two with popcount: a letter's offset is the number of children before it.
+struct PopcountX86 {
+  typedef Node NodeType;
+  static const bool kNodeRecords = false;
+  static const Node &At(uint32_t idx) { return Nodes[idx]; }
+  static uint32_t Children(const Node &node) { return PartTwoMasks[node.offset_index]; }
+  static uint32_t Offset(uint32_t children, uint32_t letter_idx) {
+    uint32_t bit = 1u << letter_idx;
+    return (children & bit) ? __builtin_popcount(children & (bit - 1)) + 1 : 0;
+  }
+};
+
+// Part Two with PEXT: extracts the letter's field without a separate shift.
+struct PextX86 {
+  typedef Node NodeType;
+  static const bool kNodeRecords = false;
+  static const Node &At(uint32_t idx) { return Nodes[idx]; }
+  static uint64_t Children(const Node &node) { return ChildOffsets[node.offset_index]; }
+  static uint64_t Offset(uint64_t children, uint32_t letter_idx) {
+    return _pext_u64(children, CHILD_MASKS[letter_idx]);
+  }
+};
+
+// The child mask encoding with a hardware popcount.
+struct ChildMaskX86 {
+  typedef WideNode NodeType;
+  static const bool kNodeRecords = false;
+  static const WideNode &At(uint32_t idx) { return WideNodes[idx]; }
+  static uint32_t Children(const WideNode &node) { return node.child_mask; }
+  static uint32_t Offset(uint32_t children, uint32_t letter_idx) {
+    uint32_t bit = 1u << letter_idx;
+    return (children & bit) ? __builtin_popcount(children & (bit - 1)) + 1 : 0;
+  }
+};
+
+// The child mask encoding over the interleaved layout.
+struct ChildMaskRecordsX86 : ChildMaskX86 {
+  static const bool kNodeRecords = true;
+  static const NodeRecord<WideNode> &Record(uint32_t idx) {
+    return WideNodeRecords[idx];
+  }
+  static const WideNode &At(uint32_t idx) { return WideNodeRecords[idx].node; }
+};
+
+}  // namespace
+
+uint32_t ScoreBoardPopcountX86(Worker *worker) {
+  return ScoreBoardWith<PopcountX86>(worker);
+}
+
+uint32_t ScoreBoardPextX86(Worker *worker) { return ScoreBoardWith<PextX86>(worker); }
+
+uint32_t ScoreBoardChildMaskX86(Worker *worker) {
+  return ScoreBoardWith<ChildMaskX86>(worker);
+}
+
+uint32_t ScoreBoardChildMaskRecordsX86(Worker *worker) {
+  return ScoreBoardWith<ChildMaskRecordsX86>(worker);
+}
+
+#endif  // HAVE_X86_SCORERS
@@ -0,0 +1,170 @@
+// Looks up every word in a file in one or more lexicons, e.g.
+//
+//     ./validatewords words.txt
+//     ./validatewords -i DTDAWG_For_TWL06.img -w enable2k.txt -t 8 words.txt
+//
+// Each line of the output is a word followed by its id in each lexicon, in the order
+// the lexicons were given, or "-" where it isn't found.  -i adds an ADTDAWG image and
+// -w adds a Trie built from a word list; with neither, the four-part Lexicon_14 files
+// are used.  Words are read and looked up a block at a time, so the input can be any
+// size.  This replaces JPA's interactive ADTDAWG_Word_Search_For_Lexicon_14.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adtdawg.h"
+#include "command_line.h"
+#include "trie.h"
+#include "word_lookup.h"
+
+using namespace std;
+
+// Zero worker threads means one per core.
+#define NUMBER_OF_WORKER_THREADS 0
+// Words are read and looked up this many at a time.
+#define WORDS_PER_BLOCK (1 << 20)
+
+// One lexicon to check the words against.
+struct Lexicon {
+  const char *name;
+  unique_ptr<Adtdawg> dawg;
+  unique_ptr<Trie> trie;
+  uint64_t found;
+};
+
+void PrintUsage(const char *program) {
+  fprintf(
+      stderr,
+      "Usage: %s [-t threads] [-i image_file]... [-w word_list]... <word_file>\n",
+      program
+  );
+  fprintf(stderr, "  -i checks the words against an ADTDAWG image.\n");
+  fprintf(stderr, "  -w checks the words against a Trie built from a word list.\n");
+  fprintf(stderr, "  A word_file of - reads from stdin.\n");
+}
+
+// Reads up to WORDS_PER_BLOCK words, one per line.
+bool ReadWords(FILE *input, vector<string> *words) {
+  char line[80];
+  words->clear();
+  while (words->size() < WORDS_PER_BLOCK && fscanf(input, "%79s", line) == 1) {
+    words->push_back(line);
+  }
+  return !words->empty();
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t num_threads = NUMBER_OF_WORKER_THREADS;
+  vector<Lexicon> lexicons;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "t:i:w:")) != -1) {
+    switch (opt) {
+      case 't':
+        if (!ParseCount(optarg, 0, kMaxThreads, &num_threads)) {
+          fprintf(stderr, "Bad value for -t: %s\n", optarg);
+          PrintUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'i':
+        lexicons.push_back({optarg, Adtdawg::MapImage(optarg), NULL, 0});
+        if (!lexicons.back().dawg.get()) {
+          return 1;
+        }
+        break;
+      case 'w':
+        lexicons.push_back({optarg, NULL, Trie::CreateFromFile(optarg), 0});
+        if (!lexicons.back().trie.get()) {
+          fprintf(stderr, "Couldn't read %s\n", optarg);
+          return 1;
+        }
+        break;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (argc - optind != 1) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+  if (lexicons.empty()) {
+    auto dawg = Adtdawg::LoadFourPart(
+        FOUR_PART_DTDAWG_14_PART_ONE,
+        FOUR_PART_DTDAWG_14_PART_TWO,
+        FOUR_PART_DTDAWG_14_PART_THREE,
+        FOUR_PART_DTDAWG_14_PART_FOUR,
+        LEXICON_14_ALPHABET
+    );
+    if (!dawg.get()) {
+      return 1;
+    }
+    lexicons.push_back({FOUR_PART_DTDAWG_14_PART_ONE, std::move(dawg), NULL, 0});
+  }
+
+  FILE *input = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "r");
+  if (!input) {
+    fprintf(stderr, "Error: Could not open file %s\n", argv[optind]);
+    return 1;
+  }
+
+  auto BeginWorkTime = chrono::steady_clock::now();
+  vector<string> words;
+  vector<vector<uint32_t>> ids(lexicons.size());
+  uint64_t num_words = 0;
+  while (ReadWords(input, &words)) {
+    for (size_t i = 0; i < lexicons.size(); i++) {
+      Lexicon &lexicon = lexicons[i];
+      ids[i] = lexicon.dawg.get() ? LookUpWords(*lexicon.dawg, words, num_threads)
+                                  : LookUpWords(*lexicon.trie, words, num_threads);
+    }
+    for (size_t w = 0; w < words.size(); w++) {
+      fputs(words[w].c_str(), stdout);
+      for (size_t i = 0; i < lexicons.size(); i++) {
+        if (ids[i][w] == kWordNotFound) {
+          fputs(" -", stdout);
+        } else {
+          printf(" %u", ids[i][w]);
+          lexicons[i].found++;
+        }
+      }
+      putchar('\n');
+    }
+    num_words += words.size();
+  }
+  auto EndWorkTime = chrono::steady_clock::now();
+  double TheRunTime = chrono::duration<double>(EndWorkTime - BeginWorkTime).count();
+  if (input != stdin) {
+    fclose(input);
+  }
+
+  fprintf(
+      stderr,
+      "Looked up %llu words in %.3f seconds, %.2f words/second\n",
+      (unsigned long long)num_words,
+      TheRunTime,
+      num_words * lexicons.size() / TheRunTime
+  );
+  for (const auto &lexicon : lexicons) {
+    fprintf(
+        stderr,
+        "%s: %llu found\n",
+        lexicon.name,
+        (unsigned long long)lexicon.found
+    );
+  }
+  return 0;
+}
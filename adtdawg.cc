@@ -0,0 +1,347 @@
+#include "adtdawg.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+using namespace std;
+
+static size_t AlignUp(size_t n) {
+  return (n + kImageAlignment - 1) / kImageAlignment * kImageAlignment;
+}
+
+static size_t NodeBytesFor(uint32_t encoding) {
+  return encoding == kChildMaskEncoding ? sizeof(WideNode) : sizeof(Node);
+}
+
+// Fills in the array offsets and total size for an image with these counts.
+static void LayoutImage(ImageHeader* header) {
+  size_t nodes_bytes = (header->num_nodes + 1) * NodeBytesFor(header->encoding);
+  size_t child_offsets_bytes = header->num_child_offsets * sizeof(uint64_t);
+  size_t tracking_bytes = (header->num_nodes + 1) * sizeof(uint32_t);
+  header->nodes_offset = AlignUp(sizeof(ImageHeader));
+  header->child_offsets_offset = AlignUp(header->nodes_offset + nodes_bytes);
+  header->tracking_offset = AlignUp(header->child_offsets_offset + child_offsets_bytes);
+  header->file_bytes = AlignUp(header->tracking_offset + tracking_bytes);
+}
+
+Adtdawg::Adtdawg()
+    : encoding_(kPartTwoEncoding),
+      nodes_(nullptr),
+      wide_nodes_(nullptr),
+      child_offsets_(nullptr),
+      tracking_(nullptr),
+      num_nodes_(0),
+      num_child_offsets_(0),
+      num_words_(0),
+      image_(nullptr),
+      image_bytes_(0),
+      mapped_(false) {}
+
+Adtdawg::~Adtdawg() {
+  if (!image_) return;
+  if (mapped_) {
+    munmap((void*)image_, image_bytes_);
+  } else {
+    free((void*)image_);
+  }
+}
+
+size_t Adtdawg::NodeBytes() const { return NodeBytesFor(encoding_); }
+
+uint32_t Adtdawg::PartTwoChildMask(uint64_t entry, size_t alphabet_size) {
+  uint32_t child_mask = 0;
+  uint32_t shift = 0;
+  for (size_t i = 0; i < alphabet_size; i++) {
+    uint32_t width = bit_width(i + 1);
+    if ((entry >> shift) & ((1ull << width) - 1)) {
+      child_mask |= 1u << i;
+    }
+    shift += width;
+  }
+  return child_mask;
+}
+
+bool Adtdawg::SetImage(const char* image, size_t image_bytes, bool mapped) {
+  image_ = image;
+  image_bytes_ = image_bytes;
+  mapped_ = mapped;
+
+  if (image_bytes < sizeof(ImageHeader)) {
+    fprintf(stderr, "ADTDAWG image is too small (%zu bytes)\n", image_bytes);
+    return false;
+  }
+  const ImageHeader* header = (const ImageHeader*)image;
+  if (memcmp(header->magic, kImageMagic, sizeof(kImageMagic)) != 0) {
+    fprintf(stderr, "Not an ADTDAWG image\n");
+    return false;
+  }
+  if (header->version != kImageVersion) {
+    fprintf(
+        stderr,
+        "ADTDAWG image version %u, expected %u\n",
+        header->version,
+        kImageVersion
+    );
+    return false;
+  }
+  if (header->encoding != kPartTwoEncoding && header->encoding != kChildMaskEncoding) {
+    fprintf(stderr, "Unknown ADTDAWG encoding %u\n", header->encoding);
+    return false;
+  }
+
+  ImageHeader expected = *header;
+  LayoutImage(&expected);
+  if (expected.nodes_offset != header->nodes_offset ||
+      expected.child_offsets_offset != header->child_offsets_offset ||
+      expected.tracking_offset != header->tracking_offset ||
+      expected.file_bytes != header->file_bytes || header->file_bytes > image_bytes ||
+      memchr(header->alphabet, '\0', kMaxAlphabetSize) == nullptr) {
+    fprintf(stderr, "ADTDAWG image header is corrupt\n");
+    return false;
+  }
+
+  encoding_ = (Encoding)header->encoding;
+  if (encoding_ == kChildMaskEncoding) {
+    wide_nodes_ = (const WideNode*)(image + header->nodes_offset);
+  } else {
+    nodes_ = (const Node*)(image + header->nodes_offset);
+  }
+  child_offsets_ = (const uint64_t*)(image + header->child_offsets_offset);
+  tracking_ = (const uint32_t*)(image + header->tracking_offset);
+  num_nodes_ = header->num_nodes;
+  num_child_offsets_ = header->num_child_offsets;
+  num_words_ = header->num_words;
+  alphabet_ = header->alphabet;
+  return BuildPartTwoMasks();
+}
+
+bool Adtdawg::BuildPartTwoMasks() {
+  part_two_masks_.clear();
+  if (encoding_ != kPartTwoEncoding) {
+    return true;
+  }
+  for (uint32_t i = 0; i < num_child_offsets_; i++) {
+    uint64_t entry = child_offsets_[i];
+    uint32_t child_mask = 0;
+    uint32_t shift = 0;
+    for (size_t j = 0; j < alphabet_.size(); j++) {
+      uint32_t width = bit_width(j + 1);
+      uint64_t offset = (entry >> shift) & ((1ull << width) - 1);
+      if (offset) {
+        if (offset != (uint64_t)popcount(child_mask) + 1) {
+          fprintf(
+              stderr, "Part Two entry %u has a bad offset for %c\n", i, alphabet_[j]
+          );
+          part_two_masks_.clear();
+          return false;
+        }
+        child_mask |= 1u << j;
+      }
+      shift += width;
+    }
+    part_two_masks_.push_back(child_mask);
+  }
+  return true;
+}
+
+unique_ptr<Adtdawg> Adtdawg::Allocate(
+    Encoding encoding,
+    const char* alphabet,
+    uint32_t num_nodes,
+    uint32_t num_child_offsets,
+    uint32_t num_words
+) {
+  if (strlen(alphabet) >= kMaxAlphabetSize) {
+    fprintf(stderr, "Alphabet %s is too long\n", alphabet);
+    return NULL;
+  }
+  ImageHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kImageMagic, sizeof(kImageMagic));
+  header.version = kImageVersion;
+  header.encoding = encoding;
+  header.num_nodes = num_nodes;
+  header.num_child_offsets = num_child_offsets;
+  header.num_words = num_words;
+  strcpy(header.alphabet, alphabet);
+  LayoutImage(&header);
+
+  char* image = (char*)aligned_alloc(kImageAlignment, header.file_bytes);
+  memset(image, 0, header.file_bytes);
+  memcpy(image, &header, sizeof(header));
+  unique_ptr<Adtdawg> dawg(new Adtdawg);
+  dawg->SetImage(image, header.file_bytes, false);
+  return dawg;
+}
+
+void Adtdawg::SetNumWords(uint32_t num_words) {
+  num_words_ = num_words;
+  ((ImageHeader*)image_)->num_words = num_words;
+}
+
+unique_ptr<Adtdawg> Adtdawg::LoadFourPart(
+    const char* part_one,
+    const char* part_two,
+    const char* part_three,
+    const char* part_four,
+    const char* alphabet
+) {
+  const char* filenames[4] = {part_one, part_two, part_three, part_four};
+  FILE* files[4];
+  for (int i = 0; i < 4; i++) {
+    files[i] = fopen(filenames[i], "rb");
+    if (!files[i]) {
+      fprintf(stderr, "Couldn't open %s\n", filenames[i]);
+      for (int j = 0; j < i; j++) fclose(files[j]);
+      return NULL;
+    }
+  }
+  FILE* PartOne = files[0];
+  FILE* PartTwo = files[1];
+  FILE* PartThree = files[2];
+  FILE* PartFour = files[3];
+
+  uint32_t SizeOfPartOne;
+  uint64_t SizeOfPartTwo;
+  uint32_t SizeOfPartThree;
+  unique_ptr<Adtdawg> dawg;
+  bool ok = false;
+
+  // Read in the size of each data file.
+  if (fread(&SizeOfPartOne, 4, 1, PartOne) == 1 &&
+      fread(&SizeOfPartTwo, 8, 1, PartTwo) == 1 &&
+      fread(&SizeOfPartThree, 4, 1, PartThree) == 1 &&
+      SizeOfPartThree <= SizeOfPartOne) {
+    dawg = Allocate(kPartTwoEncoding, alphabet, SizeOfPartOne, SizeOfPartTwo, 0);
+  }
+  if (dawg.get()) {
+    Node* Nodes = dawg->MutableNodes();
+    uint64_t* ChildOffsets = dawg->MutableChildOffsets();
+    uint32_t* Tracking = dawg->MutableTracking();
+
+    // The zero position in Part One is the NULL node, and the zero position in the
+    // tracking array maps to it.  Part Four stores the small tracking numbers as single
+    // bytes; they are widened to 32 bits here for speed.
+    size_t SizeOfPartFour = SizeOfPartOne - SizeOfPartThree;
+    vector<unsigned char> PartFourBytes(SizeOfPartFour);
+    if (fread(Nodes + 1, 4, SizeOfPartOne, PartOne) == SizeOfPartOne &&
+        fread(ChildOffsets, 8, SizeOfPartTwo, PartTwo) == SizeOfPartTwo &&
+        fread(Tracking + 1, 4, SizeOfPartThree, PartThree) == SizeOfPartThree &&
+        fread(PartFourBytes.data(), 1, SizeOfPartFour, PartFour) == SizeOfPartFour) {
+      for (size_t i = 0; i < SizeOfPartFour; i++) {
+        Tracking[SizeOfPartThree + 1 + i] = PartFourBytes[i];
+      }
+      // The first top level node's tracking number counts every word in the lexicon.
+      dawg->SetNumWords(Tracking[1]);
+      ok = dawg->BuildPartTwoMasks();
+    }
+  }
+
+  if (!ok) {
+    fprintf(stderr, "Unable to read the four part ADTDAWG from %s\n", part_one);
+  }
+  for (int i = 0; i < 4; i++) fclose(files[i]);
+  if (!ok) return NULL;
+  return dawg;
+}
+
+unique_ptr<Adtdawg> Adtdawg::MapImage(const char* filename) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Couldn't open %s\n", filename);
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    fprintf(stderr, "Couldn't stat %s\n", filename);
+    close(fd);
+    return NULL;
+  }
+  // A shared read-only mapping lets every scorer process use the same physical pages.
+  void* image = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+  close(fd);
+  if (image == MAP_FAILED) {
+    fprintf(stderr, "Couldn't map %s\n", filename);
+    return NULL;
+  }
+
+  unique_ptr<Adtdawg> dawg(new Adtdawg);
+  if (!dawg->SetImage((const char*)image, st.st_size, true)) {
+    fprintf(stderr, "Unable to use ADTDAWG image %s\n", filename);
+    return NULL;
+  }
+  return dawg;
+}
+
+bool Adtdawg::WriteImage(const char* filename) const {
+  string tmp_filename = string(filename) + ".tmp";
+  FILE* f = fopen(tmp_filename.c_str(), "wb");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", tmp_filename.c_str());
+    return false;
+  }
+  bool ok = fwrite(image_, 1, image_bytes_, f) == image_bytes_;
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp_filename.c_str(), filename) != 0) {
+    fprintf(stderr, "Couldn't write %s\n", filename);
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool Adtdawg::WriteFourPart(
+    const char* part_one,
+    const char* part_two,
+    const char* part_three,
+    const char* part_four
+) const {
+  if (encoding_ != kPartTwoEncoding) {
+    fprintf(stderr, "Only the Part Two encoding can be written as four parts\n");
+    return false;
+  }
+  const char* filenames[4] = {part_one, part_two, part_three, part_four};
+  FILE* files[4];
+  for (int i = 0; i < 4; i++) {
+    files[i] = fopen(filenames[i], "wb");
+    if (!files[i]) {
+      fprintf(stderr, "Couldn't open %s\n", filenames[i]);
+      for (int j = 0; j < i; j++) fclose(files[j]);
+      return false;
+    }
+  }
+
+  // JPA's Part Four holds bytes below 255.
+  uint32_t SizeOfPartOne = num_nodes_;
+  uint64_t SizeOfPartTwo = num_child_offsets_;
+  uint32_t SizeOfPartThree = 0;
+  for (uint32_t i = 1; i <= num_nodes_; i++) {
+    if (tracking_[i] >= 255) SizeOfPartThree = i;
+  }
+  vector<unsigned char> PartFourBytes(
+      tracking_ + SizeOfPartThree + 1, tracking_ + num_nodes_ + 1
+  );
+
+  bool ok = fwrite(&SizeOfPartOne, 4, 1, files[0]) == 1 &&
+            fwrite(nodes_ + 1, 4, SizeOfPartOne, files[0]) == SizeOfPartOne &&
+            fwrite(&SizeOfPartTwo, 8, 1, files[1]) == 1 &&
+            fwrite(child_offsets_, 8, SizeOfPartTwo, files[1]) == SizeOfPartTwo &&
+            fwrite(&SizeOfPartThree, 4, 1, files[2]) == 1 &&
+            fwrite(tracking_ + 1, 4, SizeOfPartThree, files[2]) == SizeOfPartThree &&
+            fwrite(PartFourBytes.data(), 1, PartFourBytes.size(), files[3]) ==
+                PartFourBytes.size();
+  for (int i = 0; i < 4; i++) {
+    ok = (fclose(files[i]) == 0) && ok;
+  }
+  if (!ok) {
+    fprintf(stderr, "Couldn't write the four part ADTDAWG to %s\n", part_one);
+  }
+  return ok;
+}
@@ -0,0 +1,217 @@
+// The Adamovsky Direct Tracking Directed Acyclic Word Graph, as used by GunsOfNavarone.
+//
+// An ADTDAWG is three parallel arrays:
+//   - Part One, the nodes.  Index 0 is the NULL node and indices 1..N hold the nodes.
+//   - Part Two, the child offsets.  Each entry maps every letter to its 1-based
+//     position in a node's child list (zero when there is no such child).
+//   - Parts Three and Four, the "words to end of branch list" tracking numbers, widened
+//     to a single array of 32-bit integers with the same indexing as Part One.
+//
+// JPA's Part Two encoding only fits alphabets of up to 18 letters in 64 bits.  The
+// "child mask" encoding drops Part Two and stores a bit mask of child letters in each
+// node instead; a letter's position in the child list is the popcount of the mask bits
+// below it.  This works for the full 26 letter alphabet.
+//
+// These can be loaded from JPA's four-part .dat files, or mapped read-only from a
+// single aligned image file, which needs no copying and can be shared between
+// processes.
+#ifndef ADTDAWG_H
+#define ADTDAWG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <bit>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The ADTDAWG for Lexicon_14, a subset of TWL06, is located in the 4 data files listed
+// below.  FourPartToImage converts them into the single-file image.
+#define FOUR_PART_DTDAWG_14_PART_ONE "Four_Part_1_DTDAWG_For_Lexicon_14.dat"
+#define FOUR_PART_DTDAWG_14_PART_TWO "Four_Part_2_DTDAWG_For_Lexicon_14.dat"
+#define FOUR_PART_DTDAWG_14_PART_THREE "Four_Part_3_DTDAWG_For_Lexicon_14.dat"
+#define FOUR_PART_DTDAWG_14_PART_FOUR "Four_Part_4_DTDAWG_For_Lexicon_14.dat"
+#define DTDAWG_14_IMAGE "DTDAWG_For_Lexicon_14.img"
+#define LEXICON_14_ALPHABET "ACDEGILMNOPRST"
+
+//               3          2         1
+//              1098 7654 3210 9876 5432 1098 7654 3210
+// child_index:                      111 1111 1111 1111
+// offset_index:       11 1111 1111 1000 0000 0000 0000
+// end_of_word:       100 0000 0000 0000 0000 0000 0000
+// blank:       1111 1
+
+struct Node {
+  // this is the index of the first child of this node (zero for leaf)
+  unsigned int child_index : 15;  // bits 0-14
+  // this is an index into the child offsets array
+  unsigned int offset_index : 11;  // bits 15-25
+  unsigned int is_word : 1;        // bit 26
+  int blank : 5;
+};
+
+// Part One node for the child mask encoding.
+struct WideNode {
+  // this is the index of the first child of this node (zero for leaf)
+  uint32_t child_index : 31;
+  uint32_t is_word : 1;
+  // bit i is set if the node has a child for the i'th letter of the alphabet
+  uint32_t child_mask;
+};
+
+enum Encoding : uint32_t {
+  kPartTwoEncoding = 1,    // Node + Part Two, JPA's encoding
+  kChildMaskEncoding = 2,  // WideNode, no Part Two
+};
+
+// The single-file image starts with this header.  Each array starts on a
+// kImageAlignment boundary so that it can be used in place once the file is mapped.
+const char kImageMagic[8] = {'A', 'D', 'T', 'D', 'A', 'W', 'G', '\0'};
+const uint32_t kImageVersion = 2;
+const size_t kImageAlignment = 64;
+const int kMaxAlphabetSize = 32;
+
+struct ImageHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t encoding;
+  uint32_t num_nodes;          // Part One entries, not counting the NULL node
+  uint32_t num_child_offsets;  // Part Two entries, zero for kChildMaskEncoding
+  uint32_t num_words;
+  uint64_t nodes_offset;
+  uint64_t child_offsets_offset;
+  uint64_t tracking_offset;
+  uint64_t file_bytes;
+  char alphabet[kMaxAlphabetSize];  // NUL-terminated, in child offset order
+};
+
+class Adtdawg {
+ public:
+  ~Adtdawg();
+
+  // Reads JPA's four .dat files into heap memory.  Returns NULL on failure.
+  static std::unique_ptr<Adtdawg> LoadFourPart(
+      const char* part_one,
+      const char* part_two,
+      const char* part_three,
+      const char* part_four,
+      const char* alphabet
+  );
+  // Maps an image written by WriteImage read-only.  Returns NULL on failure.
+  static std::unique_ptr<Adtdawg> MapImage(const char* filename);
+
+  // Writes JPA's four .dat files.  Only works for the Part Two encoding.  Tracking
+  // numbers go in Part Three up to the last one that doesn't fit in a byte, and in Part
+  // Four after that.
+  bool WriteFourPart(
+      const char* part_one,
+      const char* part_two,
+      const char* part_three,
+      const char* part_four
+  ) const;
+  // Writes a single-file image.  The image is written to a temporary file and renamed
+  // into place, so processes mapping the old image never see a partial file.
+  bool WriteImage(const char* filename) const;
+
+  Encoding GetEncoding() const { return encoding_; }
+  // Only one of these is set, depending on the encoding.
+  const Node* Nodes() const { return nodes_; }
+  const WideNode* WideNodes() const { return wide_nodes_; }
+  const uint64_t* ChildOffsets() const { return child_offsets_; }
+  const uint32_t* Tracking() const { return tracking_; }
+  // ChildMask for each Part Two entry, for the Part Two encoding only.
+  const uint32_t* PartTwoMasks() const { return part_two_masks_.data(); }
+
+  uint32_t NumNodes() const { return num_nodes_; }
+  uint32_t NumChildOffsets() const { return num_child_offsets_; }
+  // Word ids run from 1 to NumWords(), so marks arrays need NumWords() + 1 entries.
+  uint32_t NumWords() const { return num_words_; }
+  const std::string& Alphabet() const { return alphabet_; }
+
+  // Size of the image, i.e. the header plus all three arrays.
+  size_t Bytes() const { return image_bytes_; }
+  bool IsMapped() const { return mapped_; }
+  // Bytes per Part One entry.
+  size_t NodeBytes() const;
+
+  // Walking the graph, for either encoding.  Nodes 1 to Alphabet().size() are the top
+  // level letters, and letters are positions in Alphabet().  Every node on the way down
+  // has a word index, which is the word's id if the node ends a word: the top level
+  // node for letter i has index Tracking()[i + 1], and ChildWordIndex gives the index
+  // of each child.
+  uint32_t FirstChild(uint32_t node) const {
+    return wide_nodes_ ? wide_nodes_[node].child_index : nodes_[node].child_index;
+  }
+  // Bit i is set if the node has a child for letter i.
+  uint32_t ChildMask(uint32_t node) const {
+    return wide_nodes_ ? wide_nodes_[node].child_mask
+                       : part_two_masks_[nodes_[node].offset_index];
+  }
+  bool IsWord(uint32_t node) const {
+    return wide_nodes_ ? wide_nodes_[node].is_word : nodes_[node].is_word;
+  }
+  // Returns the node's child for "letter," or zero if it has none.
+  uint32_t Child(uint32_t node, uint32_t letter) const {
+    uint32_t mask = ChildMask(node);
+    uint32_t bit = 1u << letter;
+    if (!(mask & bit)) {
+      return 0;
+    }
+    return FirstChild(node) + std::popcount(mask & (bit - 1));
+  }
+  uint32_t ChildWordIndex(uint32_t node, uint32_t word_index, uint32_t child) const {
+    return word_index + tracking_[child] - tracking_[FirstChild(node)] - IsWord(node);
+  }
+
+  // The letters with a child in a Part Two entry.  Letter i's field holds offsets up to
+  // i + 1, so it is bit_width(i + 1) bits wide.
+  static uint32_t PartTwoChildMask(uint64_t entry, size_t alphabet_size);
+
+ private:
+  friend class AdtdawgBuilder;
+
+  Adtdawg();
+  // Allocates a zeroed heap image with room for the given counts.  The caller fills
+  // in the arrays through the Mutable accessors.  Returns NULL if the alphabet is too
+  // long.
+  static std::unique_ptr<Adtdawg> Allocate(
+      Encoding encoding,
+      const char* alphabet,
+      uint32_t num_nodes,
+      uint32_t num_child_offsets,
+      uint32_t num_words
+  );
+  Node* MutableNodes() { return const_cast<Node*>(nodes_); }
+  WideNode* MutableWideNodes() { return const_cast<WideNode*>(wide_nodes_); }
+  uint64_t* MutableChildOffsets() { return const_cast<uint64_t*>(child_offsets_); }
+  uint32_t* MutableTracking() { return const_cast<uint32_t*>(tracking_); }
+  // Updates the word count in both this object and the image header.
+  void SetNumWords(uint32_t num_words);
+  // Points the arrays into "image" after checking that the header describes it.
+  bool SetImage(const char* image, size_t image_bytes, bool mapped);
+  // Recomputes part_two_masks_ after Part Two has been filled in.  Returns false if an
+  // entry's offsets aren't each one more than the number of children before them,
+  // since ChildMask and Child would then find the wrong children.
+  bool BuildPartTwoMasks();
+
+  Encoding encoding_;
+  const Node* nodes_;
+  const WideNode* wide_nodes_;
+  const uint64_t* child_offsets_;
+  const uint32_t* tracking_;
+  uint32_t num_nodes_;
+  uint32_t num_child_offsets_;
+  uint32_t num_words_;
+  std::string alphabet_;
+  // ChildMask for each Part Two entry.
+  std::vector<uint32_t> part_two_masks_;
+
+  // The image is either mapped from a file or heap-allocated by LoadFourPart.  It is
+  // laid out the same way in both cases.
+  const char* image_;
+  size_t image_bytes_;
+  bool mapped_;
+};
+
+#endif  // ADTDAWG_H
@@ -0,0 +1,176 @@
+#include "adtdawg_anagram.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <atomic>
+#include <bit>
+#include <thread>
+
+using namespace std;
+
+Anagrammer::Anagrammer(const Adtdawg& dawg)
+    : dawg_(dawg),
+      marks_(dawg.NumWords() + 1, 0),
+      mark_(0),
+      available_(0),
+      blanks_(0),
+      tiles_left_(0),
+      options_(nullptr),
+      found_(nullptr),
+      num_found_(0) {
+  for (int i = 0; i < 26; i++) {
+    letter_indices_[i] = -1;
+  }
+  const string& alphabet = dawg.Alphabet();
+  for (size_t i = 0; i < alphabet.size(); i++) {
+    letter_indices_[alphabet[i] - 'A'] = i;
+  }
+  memset(counts_, 0, sizeof(counts_));
+}
+
+size_t Anagrammer::Find(
+    const string& rack, const AnagramOptions& options, const Callback& found
+) {
+  memset(counts_, 0, sizeof(counts_));
+  available_ = 0;
+  blanks_ = 0;
+  tiles_left_ = 0;
+  for (size_t i = 0; i < rack.size(); i++) {
+    char c = toupper(rack[i]);
+    if (c == '?') {
+      blanks_++;
+      tiles_left_++;
+      continue;
+    }
+    if (c == 'Q' && i + 1 < rack.size() && toupper(rack[i + 1]) == 'U') {
+      i++;
+    }
+    if (c < 'A' || c > 'Z' || letter_indices_[c - 'A'] < 0) {
+      continue;
+    }
+    int letter = letter_indices_[c - 'A'];
+    counts_[letter]++;
+    available_ |= 1u << letter;
+    tiles_left_++;
+  }
+
+  // A new mark for every rack; when they run out, the marks are cleared.
+  if (++mark_ == 0) {
+    fill(marks_.begin(), marks_.end(), 0);
+    mark_ = 1;
+  }
+  options_ = &options;
+  found_ = &found;
+  num_found_ = 0;
+  word_.clear();
+
+  // The top level nodes act as the root's children.
+  uint32_t all_letters = (1u << dawg_.Alphabet().size()) - 1;
+  uint32_t playable = blanks_ ? all_letters : available_;
+  while (playable) {
+    uint32_t letter = countr_zero(playable);
+    playable &= playable - 1;
+    uint32_t node = letter + 1;
+    Play(letter, node, dawg_.Tracking()[node], 1);
+  }
+  return num_found_;
+}
+
+void Anagrammer::Search(uint32_t node, uint32_t word_index, uint32_t length) {
+  bool is_word = dawg_.IsWord(node);
+  if (is_word && length >= options_->min_length &&
+      (options_->sub_anagrams || tiles_left_ == 0) && marks_[word_index] != mark_) {
+    marks_[word_index] = mark_;
+    num_found_++;
+    (*found_)(word_index, word_);
+  }
+  uint32_t first_child = dawg_.FirstChild(node);
+  if (!first_child || !tiles_left_) {
+    return;
+  }
+
+  uint32_t child_mask = dawg_.ChildMask(node);
+  uint32_t playable = blanks_ ? child_mask : child_mask & available_;
+  while (playable) {
+    uint32_t letter = countr_zero(playable);
+    playable &= playable - 1;
+    uint32_t child = first_child + popcount(child_mask & ((1u << letter) - 1));
+    Play(letter, child, dawg_.ChildWordIndex(node, word_index, child), length + 1);
+  }
+}
+
+void Anagrammer::Play(
+    uint32_t letter, uint32_t node, uint32_t word_index, uint32_t length
+) {
+  // Real tiles go first: a blank never spells anything a real tile couldn't.
+  uint32_t bit = 1u << letter;
+  bool blank = !(available_ & bit);
+  if (blank) {
+    blanks_--;
+  } else if (--counts_[letter] == 0) {
+    available_ &= ~bit;
+  }
+  tiles_left_--;
+  size_t word_length = word_.size();
+  char c = dawg_.Alphabet()[letter];
+  word_.push_back(blank ? tolower(c) : c);
+  if (c == 'Q') {
+    word_.push_back(blank ? 'u' : 'U');
+  }
+
+  Search(node, word_index, length);
+
+  word_.resize(word_length);
+  tiles_left_++;
+  if (blank) {
+    blanks_++;
+  } else {
+    counts_[letter]++;
+    available_ |= bit;
+  }
+}
+
+static void AnagramRacksWorker(
+    const Adtdawg& dawg,
+    const vector<string>& racks,
+    const AnagramOptions& options,
+    vector<AnagramList>& results,
+    atomic<size_t>& next_rack
+) {
+  Anagrammer anagrammer(dawg);
+  AnagramList* words;
+  Anagrammer::Callback found = [&words](uint32_t word_id, const string& word) {
+    words->push_back(word);
+  };
+  for (size_t i = next_rack++; i < racks.size(); i = next_rack++) {
+    words = &results[i];
+    anagrammer.Find(racks[i], options, found);
+  }
+}
+
+vector<AnagramList> AnagramRacks(
+    const Adtdawg& dawg,
+    const vector<string>& racks,
+    const AnagramOptions& options,
+    uint32_t num_threads
+) {
+  vector<AnagramList> results(racks.size());
+  atomic<size_t> next_rack(0);
+  vector<thread> threads;
+  for (uint32_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(
+        AnagramRacksWorker,
+        cref(dawg),
+        cref(racks),
+        cref(options),
+        ref(results),
+        ref(next_rack)
+    );
+  }
+  AnagramRacksWorker(dawg, racks, options, results, next_rack);
+  for (auto& t : threads) {
+    t.join();
+  }
+  return results;
+}
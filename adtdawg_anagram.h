@@ -0,0 +1,80 @@
+// Finds the words that can be spelled from racks of letter tiles, over an ADTDAWG.
+//
+// This is JPA's TrackingAnagramWithFourPartDawgArray as a library call: the search
+// walks the ADTDAWG with the rack's letters, keeping each node's word index as it goes,
+// and a word reached twice is only reported once because its index is stamped in a
+// per-Anagrammer array of marks.  Each thread needs its own Anagrammer; AnagramRacks
+// spreads a batch of racks over threads that way.
+//
+// A rack is a string of letters, with "?" for a blank that can stand for any letter.
+// Characters that aren't in the lexicon's alphabet are ignored, as in JPA's tool.  The
+// lexicons here are Boggle lexicons, so a Q tile is the "Qu" die ("QU" in a rack is
+// one tile) and words come back spelled with "QU."
+#ifndef ADTDAWG_ANAGRAM_H
+#define ADTDAWG_ANAGRAM_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "adtdawg.h"
+
+struct AnagramOptions {
+  // Also find words that leave some tiles unused.
+  bool sub_anagrams;
+  // Shortest word to report, in tiles.
+  uint32_t min_length;
+};
+
+class Anagrammer {
+ public:
+  // Called with each word's id and spelling.  Letters played with a blank are lower
+  // case.
+  typedef std::function<void(uint32_t word_id, const std::string& word)> Callback;
+
+  explicit Anagrammer(const Adtdawg& dawg);
+
+  // Calls "found" once for every distinct word in the rack, in alphabetical order, and
+  // returns how many there were.
+  size_t Find(
+      const std::string& rack, const AnagramOptions& options, const Callback& found
+  );
+
+ private:
+  // Reports the word ending at "node," if any, then tries each tile left on the rack
+  // against its children.
+  void Search(uint32_t node, uint32_t word_index, uint32_t length);
+  // Takes a tile for "letter" off the rack, searches from "node" and puts it back.
+  void Play(uint32_t letter, uint32_t node, uint32_t word_index, uint32_t length);
+
+  const Adtdawg& dawg_;
+  int letter_indices_[26];
+  std::vector<uint32_t> marks_;
+  uint32_t mark_;
+
+  // The rack being searched.
+  uint8_t counts_[kMaxAlphabetSize];
+  uint32_t available_;  // bit i is set while counts_[i] is nonzero
+  uint32_t blanks_;
+  uint32_t tiles_left_;
+  std::string word_;
+  const AnagramOptions* options_;
+  const Callback* found_;
+  size_t num_found_;
+};
+
+// The words found for one rack, spelled as for Anagrammer::Callback.
+typedef std::vector<std::string> AnagramList;
+
+// Anagrams every rack on "num_threads" threads, including the calling one, and returns
+// the words for each rack in input order.
+std::vector<AnagramList> AnagramRacks(
+    const Adtdawg& dawg,
+    const std::vector<std::string>& racks,
+    const AnagramOptions& options,
+    uint32_t num_threads
+);
+
+#endif  // ADTDAWG_ANAGRAM_H
@@ -0,0 +1,118 @@
+#include "adtdawg_boggler.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+using namespace std;
+
+AdtdawgBoggler::AdtdawgBoggler(const Adtdawg& dawg, int rows, int columns)
+    : dawg_(dawg),
+      rows_(rows),
+      columns_(columns),
+      neighbors_(rows * columns),
+      marks_(dawg.NumWords() + 1, 0),
+      mark_(0),
+      used_(0),
+      multiboggle_(false),
+      words_(nullptr) {
+  for (int i = 0; i < 26; i++) {
+    letter_indices_[i] = -1;
+  }
+  for (size_t i = 0; i < dawg.Alphabet().size(); i++) {
+    letter_indices_[dawg.Alphabet()[i] - 'A'] = i;
+  }
+  for (int row = 0; row < rows; row++) {
+    for (int col = 0; col < columns; col++) {
+      for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+          int r = row + dr;
+          int c = col + dc;
+          if ((dr || dc) && r >= 0 && r < rows && c >= 0 && c < columns) {
+            neighbors_[row * columns + col].push_back(r * columns + c);
+          }
+        }
+      }
+    }
+  }
+}
+
+bool AdtdawgBoggler::FindWords(
+    const string& board, bool multiboggle, vector<FoundWord>* words
+) {
+  size_t num_cells = rows_ * columns_;
+  if (num_cells > kMaxCells || board.size() != num_cells) {
+    fprintf(
+        stderr,
+        "Board strings must contain %zu characters, got %zu ('%s')\n",
+        num_cells,
+        board.size(),
+        board.c_str()
+    );
+    return false;
+  }
+  for (size_t i = 0; i < num_cells; i++) {
+    char c = toupper(board[i]);
+    if (c == '.') {
+      cells_[i] = -1;
+    } else if (c >= 'A' && c <= 'Z') {
+      cells_[i] = letter_indices_[c - 'A'];
+    } else {
+      fprintf(stderr, "Found unexpected letter: '%c'\n", board[i]);
+      return false;
+    }
+  }
+
+  // A new mark for every board; when they run out, the marks are cleared.
+  if (++mark_ == 0) {
+    fill(marks_.begin(), marks_.end(), 0);
+    mark_ = 1;
+  }
+  multiboggle_ = multiboggle;
+  found_words_.clear();
+  path_.clear();
+  used_ = 0;
+  words_ = words;
+  words->clear();
+  // The top level nodes act as the root's children.
+  for (uint32_t i = 0; i < num_cells; i++) {
+    if (cells_[i] != -1) {
+      uint32_t node = cells_[i] + 1;
+      FindWordsDFS(i, node, dawg_.Tracking()[node]);
+    }
+  }
+  return true;
+}
+
+void AdtdawgBoggler::FindWordsDFS(uint32_t cell, uint32_t node, uint32_t word_index) {
+  used_ ^= 1u << cell;
+  path_.push_back(cell);
+  if (dawg_.IsWord(node)) {
+    bool should_count;
+    if (multiboggle_) {
+      uint64_t key = ((uint64_t)word_index << 32) + used_;
+      should_count = found_words_.emplace(key).second;
+    } else {
+      should_count = marks_[word_index] != mark_;
+      marks_[word_index] = mark_;
+    }
+    if (should_count) {
+      words_->push_back({word_index, path_});
+    }
+  }
+
+  if (dawg_.FirstChild(node)) {
+    for (uint32_t next : neighbors_[cell]) {
+      if ((used_ & (1u << next)) == 0 && cells_[next] != -1) {
+        uint32_t child = dawg_.Child(node, cells_[next]);
+        if (child) {
+          FindWordsDFS(next, child, dawg_.ChildWordIndex(node, word_index, child));
+        }
+      }
+    }
+  }
+
+  used_ ^= 1u << cell;
+  path_.pop_back();
+}
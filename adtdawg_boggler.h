@@ -0,0 +1,63 @@
+// Lists the words on a Boggle board, with the cells that spell them, over an ADTDAWG.
+//
+// This is Boggler::FindWords for the web UI without the Trie: the ADTDAWG for a
+// lexicon is a few hundred KB where the Trie is tens of MB.  Words come back as ids
+// from the tracking numbers, which a WordTable turns into strings.  As in
+// Boggler::FindWords, a word is reported once per board, or with "multiboggle" once
+// per distinct set of cells.
+//
+// Boards are strings of rows * columns letters, in rows, with "Q" for the "Qu" die and
+// "." for a cell that can't be used.  Letters outside the lexicon's alphabet can't be
+// used either.  A board can have at most 32 cells.  Each thread needs its own
+// AdtdawgBoggler.
+#ifndef ADTDAWG_BOGGLER_H
+#define ADTDAWG_BOGGLER_H
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "adtdawg.h"
+
+struct FoundWord {
+  uint32_t word_id;
+  // The cells spelling the word, as indices into the board string.
+  std::vector<int> path;
+};
+
+class AdtdawgBoggler {
+ public:
+  static const int kMaxCells = 32;
+
+  AdtdawgBoggler(const Adtdawg& dawg, int rows, int columns);
+
+  // Fills "words" with the words on "board" in the order they are found.  Returns false
+  // if the board can't be parsed.
+  bool FindWords(
+      const std::string& board, bool multiboggle, std::vector<FoundWord>* words
+  );
+
+ private:
+  void FindWordsDFS(uint32_t cell, uint32_t node, uint32_t word_index);
+
+  const Adtdawg& dawg_;
+  int rows_;
+  int columns_;
+  int letter_indices_[26];
+  // neighbors_[i] lists the cells next to cell i.
+  std::vector<std::vector<uint32_t>> neighbors_;
+  std::vector<uint32_t> marks_;
+  uint32_t mark_;
+
+  // The board being searched.
+  int cells_[kMaxCells];  // letter indices, or -1 for cells that can't be used
+  uint32_t used_;
+  std::vector<int> path_;
+  bool multiboggle_;
+  std::unordered_set<uint64_t> found_words_;
+  std::vector<FoundWord>* words_;
+};
+
+#endif  // ADTDAWG_BOGGLER_H
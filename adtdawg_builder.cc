@@ -0,0 +1,732 @@
+#include "adtdawg_builder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+
+#include "trie.h"
+
+using namespace std;
+
+AdtdawgBuilder::AdtdawgBuilder(const string& alphabet, size_t max_length)
+    : alphabet_(alphabet),
+      max_length_(max_length),
+      sublist_sharing_(true),
+      relayout_(false),
+      words_added_(0),
+      words_removed_(0),
+      root_(0) {
+  for (int i = 0; i < 26; i++) {
+    letter_indices_[i] = -1;
+  }
+  for (size_t i = 0; i < alphabet.size(); i++) {
+    letter_indices_[alphabet[i] - 'A'] = i;
+  }
+}
+
+unique_ptr<AdtdawgBuilder> AdtdawgBuilder::FromAdtdawg(
+    const Adtdawg& dawg, size_t max_length
+) {
+  unique_ptr<AdtdawgBuilder> builder(new AdtdawgBuilder(dawg.Alphabet(), max_length));
+  size_t alphabet_size = dawg.Alphabet().size();
+  uint32_t num_nodes = dawg.NumNodes();
+  if (num_nodes < alphabet_size) {
+    fprintf(stderr, "ADTDAWG has %u nodes, fewer than its alphabet\n", num_nodes);
+    return NULL;
+  }
+
+  // Decode every node to the same form for both encodings.
+  vector<uint32_t> child_indices(num_nodes + 1, 0);
+  vector<uint32_t> child_masks(num_nodes + 1, 0);
+  vector<bool> is_words(num_nodes + 1, false);
+  for (uint32_t i = 1; i <= num_nodes; i++) {
+    if (dawg.GetEncoding() == kChildMaskEncoding) {
+      const WideNode& node = dawg.WideNodes()[i];
+      child_indices[i] = node.child_index;
+      child_masks[i] = node.child_mask;
+      is_words[i] = node.is_word;
+    } else {
+      const Node& node = dawg.Nodes()[i];
+      if (node.offset_index >= dawg.NumChildOffsets()) {
+        fprintf(stderr, "Node %u has a bad Part Two index\n", i);
+        return NULL;
+      }
+      child_indices[i] = node.child_index;
+      uint64_t entry = dawg.ChildOffsets()[node.offset_index];
+      child_masks[i] = Adtdawg::PartTwoChildMask(entry, alphabet_size);
+      is_words[i] = node.is_word;
+    }
+    uint32_t num_children = popcount(child_masks[i]);
+    if ((child_indices[i] == 0) != (num_children == 0) ||
+        child_masks[i] >> alphabet_size ||
+        child_indices[i] + num_children > num_nodes + 1) {
+      fprintf(stderr, "Node %u has a bad child list\n", i);
+      return NULL;
+    }
+  }
+
+  // Each node's state is interned after its children's, as in a fresh build.  A node
+  // without words can only be a top level letter that starts none.
+  enum { kUnvisited, kVisiting, kDone };
+  vector<uint8_t> visits(num_nodes + 1, kUnvisited);
+  vector<uint32_t> node_states(num_nodes + 1, kNoState);
+  bool ok = true;
+  auto load = [&](auto& self, uint32_t i) -> uint32_t {
+    if (visits[i] != kUnvisited) {
+      ok = ok && visits[i] == kDone;
+      return node_states[i];
+    }
+    visits[i] = kVisiting;
+    State state;
+    state.is_word = is_words[i];
+    state.words_under = state.is_word;
+    state.child_mask = child_masks[i];
+    uint32_t child_idx = child_indices[i];
+    for (uint32_t letter = 0; letter < alphabet_size; letter++) {
+      if (!(state.child_mask & (1u << letter))) {
+        continue;
+      }
+      uint32_t child = self(self, child_idx++);
+      if (child == kNoState) {
+        ok = false;
+        break;
+      }
+      state.children.push_back({(uint8_t)letter, child});
+      state.words_under += builder->states_[child].words_under;
+    }
+    if (ok && (state.is_word || !state.children.empty())) {
+      node_states[i] = builder->Intern(std::move(state));
+    }
+    visits[i] = kDone;
+    return node_states[i];
+  };
+  for (uint32_t i = 1; i <= num_nodes && ok; i++) {
+    load(load, i);
+  }
+  if (!ok) {
+    fprintf(stderr, "ADTDAWG child lists don't form a DAWG\n");
+    return NULL;
+  }
+
+  State root;
+  root.is_word = false;
+  root.words_under = 0;
+  root.child_mask = 0;
+  for (uint32_t letter = 0; letter < alphabet_size; letter++) {
+    uint32_t child = node_states[letter + 1];
+    if (child != kNoState) {
+      root.children.push_back({(uint8_t)letter, child});
+      root.child_mask |= 1u << letter;
+      root.words_under += builder->states_[child].words_under;
+    }
+  }
+  builder->root_ = builder->Intern(std::move(root));
+  if (builder->NumWords() != dawg.NumWords()) {
+    fprintf(
+        stderr,
+        "ADTDAWG holds %zu words, but its header says %u\n",
+        builder->NumWords(),
+        dawg.NumWords()
+    );
+    return NULL;
+  }
+
+  // Keep the existing layout, so that a patch only appends to it.
+  const uint32_t* tracking = dawg.Tracking();
+  builder->entries_.resize(num_nodes + 1);
+  builder->entries_[0] = {kNoState, 0};
+  builder->child_index_.assign(builder->states_.size(), 0);
+  for (uint32_t i = 1; i <= num_nodes; i++) {
+    uint32_t s = node_states[i];
+    builder->entries_[i] = {s, tracking[i]};
+    if (s == kNoState || !child_indices[i] || builder->child_index_[s]) {
+      continue;
+    }
+    builder->child_index_[s] = child_indices[i];
+    builder->list_starts_.emplace(builder->ListKey(s), child_indices[i]);
+    if (child_indices[i] <= alphabet_size) {
+      builder->top_level_runs_.push_back(s);
+    }
+  }
+  return builder;
+}
+
+bool AdtdawgBuilder::ToBoggleWord(char* word) {
+  for (char* c = word; *c; c++) {
+    *c = tolower(*c);
+  }
+  if (!Trie::BogglifyWord(word)) {
+    return false;
+  }
+  for (char* c = word; *c; c++) {
+    *c = toupper(*c);
+  }
+  return true;
+}
+
+bool AdtdawgBuilder::AddWordsFromFile(const char* filename) {
+  FILE* f = fopen(filename, "r");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", filename);
+    return false;
+  }
+  char line[80];
+  while (fscanf(f, "%79s", line) == 1) {
+    if (ToBoggleWord(line)) {
+      AddWord(line);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+bool AdtdawgBuilder::AddPatchFromFile(const char* filename) {
+  FILE* f = fopen(filename, "r");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", filename);
+    return false;
+  }
+  char line[80];
+  while (fscanf(f, "%79s", line) == 1) {
+    char* word = line;
+    bool add = true;
+    if (*word == '+' || *word == '-') {
+      add = *word == '+';
+      word++;
+    }
+    if (!ToBoggleWord(word)) {
+      continue;
+    }
+    if (add) {
+      AddWord(word);
+    } else {
+      RemoveWord(word);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+bool AdtdawgBuilder::ToIndices(const string& word, string* indices) const {
+  if (word.empty() || (max_length_ && word.size() > max_length_)) {
+    return false;
+  }
+  indices->clear();
+  for (char c : word) {
+    if (c < 'A' || c > 'Z' || letter_indices_[c - 'A'] < 0) {
+      return false;
+    }
+    indices->push_back(letter_indices_[c - 'A']);
+  }
+  return true;
+}
+
+bool AdtdawgBuilder::AddWord(const string& word) {
+  string indices;
+  if (!ToIndices(word, &indices)) {
+    return false;
+  }
+  // Before the first build, words are collected and sorted, which is much faster than
+  // patching them in one at a time.
+  if (states_.empty() && patch_.empty()) {
+    words_.push_back(indices);
+  } else {
+    patch_.push_back({indices, true});
+  }
+  return true;
+}
+
+bool AdtdawgBuilder::RemoveWord(const string& word) {
+  string indices;
+  if (!ToIndices(word, &indices)) {
+    return false;
+  }
+  patch_.push_back({indices, false});
+  return true;
+}
+
+// JPA packs a child list position for every letter into one 64-bit Part Two entry.
+// The i'th letter has at most i children before it, so its field only needs room for
+// offsets up to i + 1.
+uint64_t AdtdawgBuilder::PartTwoEntry(uint32_t child_mask, size_t alphabet_size) {
+  uint64_t entry = 0;
+  uint32_t shift = 0;
+  uint64_t offset = 0;
+  for (size_t i = 0; i < alphabet_size; i++) {
+    if (child_mask & (1u << i)) {
+      entry |= ++offset << shift;
+    }
+    shift += bit_width(i + 1);
+  }
+  return entry;
+}
+
+uint32_t AdtdawgBuilder::Intern(State&& state) {
+  // The key is everything that makes two states equivalent.
+  string key(1, state.is_word);
+  for (const auto& [letter, child] : state.children) {
+    key.push_back(letter);
+    key.append((const char*)&child, sizeof(child));
+  }
+  auto it = registry_.find(key);
+  if (it != registry_.end()) {
+    return it->second;
+  }
+  uint32_t id = states_.size();
+  states_.push_back(std::move(state));
+  registry_.emplace(std::move(key), id);
+  return id;
+}
+
+// Builds the state for the words in [begin, end), which all share their first "depth"
+// letters.  Children are built before their parents, so they can be interned first.
+uint32_t AdtdawgBuilder::BuildStates(size_t begin, size_t end, size_t depth) {
+  State state;
+  state.is_word = false;
+  state.words_under = 0;
+  state.child_mask = 0;
+  if (begin < end && words_[begin].size() == depth) {
+    state.is_word = true;
+    state.words_under = 1;
+    begin++;
+  }
+  while (begin < end) {
+    uint8_t letter = words_[begin][depth];
+    size_t next = begin;
+    while (next < end && (uint8_t)words_[next][depth] == letter) {
+      next++;
+    }
+    uint32_t child = BuildStates(begin, next, depth + 1);
+    state.children.push_back({letter, child});
+    state.child_mask |= 1u << letter;
+    state.words_under += states_[child].words_under;
+    begin = next;
+  }
+  return Intern(std::move(state));
+}
+
+uint32_t AdtdawgBuilder::PatchState(
+    uint32_t s, const string& word, size_t depth, bool add
+) {
+  State state;
+  if (s != kNoState) {
+    state = states_[s];
+  } else {
+    state.is_word = false;
+  }
+  if (depth == word.size()) {
+    if (state.is_word == add) {
+      return s;
+    }
+    state.is_word = add;
+  } else {
+    uint8_t letter = word[depth];
+    auto it = state.children.begin();
+    while (it != state.children.end() && it->first < letter) {
+      it++;
+    }
+    bool found = it != state.children.end() && it->first == letter;
+    uint32_t child = found ? it->second : kNoState;
+    if (!found && !add) {
+      return s;
+    }
+    uint32_t patched = PatchState(child, word, depth + 1, add);
+    if (patched == child) {
+      return s;
+    }
+    if (patched == kNoState) {
+      state.children.erase(it);
+    } else if (found) {
+      it->second = patched;
+    } else {
+      state.children.insert(it, {letter, patched});
+    }
+  }
+  if (!state.is_word && state.children.empty()) {
+    return kNoState;
+  }
+
+  // Every state is immutable once interned, so the patched one is a new state unless
+  // it happens to equal an existing one.
+  state.words_under = state.is_word;
+  state.child_mask = 0;
+  for (const auto& [letter, child] : state.children) {
+    state.child_mask |= 1u << letter;
+    state.words_under += states_[child].words_under;
+  }
+  return Intern(std::move(state));
+}
+
+bool AdtdawgBuilder::Layout() {
+  bool patch = !relayout_ && !entries_.empty();
+  relayout_ = false;
+  if (states_.empty()) {
+    sort(words_.begin(), words_.end());
+    words_.erase(unique(words_.begin(), words_.end()), words_.end());
+    root_ = BuildStates(0, words_.size(), 0);
+    words_added_ = words_.size();
+    vector<string>().swap(words_);
+  } else {
+    words_added_ = 0;
+  }
+
+  words_removed_ = 0;
+  for (const auto& [word, add] : patch_) {
+    size_t before = NumWords();
+    root_ = PatchState(root_, word, 0, add);
+    if (root_ == kNoState) {
+      root_ = Intern({false, 0, 0, {}});
+    }
+    if (add) {
+      words_added_ += NumWords() - before;
+    } else {
+      words_removed_ += before - NumWords();
+    }
+  }
+  patch_.clear();
+
+  if (patch) {
+    LayoutPatch();
+  } else {
+    LayoutAll();
+  }
+  return patch;
+}
+
+vector<uint32_t> AdtdawgBuilder::RootChildren() const {
+  // Every letter gets a top level node at index letter + 1, whether or not it starts
+  // any words, so that the scorer can find it without a lookup.
+  vector<uint32_t> root_children(alphabet_.size(), kNoState);
+  for (const auto& [letter, child] : states_[root_].children) {
+    root_children[letter] = child;
+  }
+  return root_children;
+}
+
+string AdtdawgBuilder::ListKey(uint32_t s) const {
+  string key;
+  for (const auto& [letter, child] : states_[s].children) {
+    key.append((const char*)&child, sizeof(child));
+  }
+  return key;
+}
+
+bool AdtdawgBuilder::ListMatches(uint32_t s, uint32_t start) const {
+  const auto& children = states_[s].children;
+  if (start == 0 || start + children.size() > entries_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < children.size(); i++) {
+    if (entries_[start + i].state != children[i].second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The tracking number for each entry counts the words below it and below its later
+// siblings.
+uint32_t AdtdawgBuilder::AppendList(const vector<uint32_t>& states) {
+  uint32_t tracking = 0;
+  size_t start = entries_.size();
+  entries_.resize(start + states.size());
+  for (size_t i = states.size(); i-- > 0;) {
+    uint32_t s = states[i];
+    if (s != kNoState) {
+      tracking += states_[s].words_under;
+    }
+    entries_[start + i] = {s, tracking};
+  }
+  return start;
+}
+
+void AdtdawgBuilder::LayoutAll() {
+  child_index_.assign(states_.size(), 0);
+  list_starts_.clear();
+  top_level_runs_.clear();
+  vector<uint32_t> root_children = RootChildren();
+  entries_.assign(1, {kNoState, 0});
+  AppendList(root_children);
+
+  // Find the remaining lists breadth first, sharing lists between states whose
+  // children are the same sequence of states.
+  vector<vector<uint32_t>> lists;
+  vector<uint32_t> list_words;  // words under each list, i.e. its first tracking number
+  vector<uint32_t> state_lists(states_.size(), kNoState);
+  unordered_map<string, uint32_t> list_ids;
+  deque<uint32_t> queue(root_children.begin(), root_children.end());
+  vector<bool> seen(states_.size(), false);
+  while (!queue.empty()) {
+    uint32_t s = queue.front();
+    queue.pop_front();
+    if (s == kNoState || seen[s]) {
+      continue;
+    }
+    seen[s] = true;
+    const State& state = states_[s];
+    if (state.children.empty()) {
+      continue;
+    }
+    vector<uint32_t> child_states;
+    string key = ListKey(s);
+    uint32_t words = 0;
+    for (const auto& [letter, child] : state.children) {
+      child_states.push_back(child);
+      words += states_[child].words_under;
+      queue.push_back(child);
+    }
+    auto it = list_ids.find(key);
+    if (it == list_ids.end()) {
+      it = list_ids.emplace(key, lists.size()).first;
+      lists.push_back(std::move(child_states));
+      list_words.push_back(words);
+    }
+    state_lists[s] = it->second;
+  }
+
+  // A list that appears as a contiguous run inside a longer list doesn't need its own
+  // copy; its states can point into the middle of the longer one.  Child offsets only
+  // depend on the order of the run, and the difference between two tracking numbers
+  // only counts the words under the entries between them, so both come out the same.
+  // Longer lists are placed first, and every run of a placed list is indexed.
+  uint32_t root_list = lists.size();
+  vector<uint32_t> owners(lists.size());
+  vector<uint32_t> owner_offsets(lists.size(), 0);
+  for (uint32_t i = 0; i < lists.size(); i++) {
+    owners[i] = i;
+  }
+  if (sublist_sharing_) {
+    unordered_map<string, pair<uint32_t, uint32_t>> runs;
+    auto add_runs = [&runs](const vector<uint32_t>& list, uint32_t owner) {
+      for (size_t begin = 0; begin < list.size(); begin++) {
+        string key;
+        for (size_t end = begin; end < list.size() && list[end] != kNoState; end++) {
+          key.append((const char*)&list[end], sizeof(list[end]));
+          runs.emplace(key, make_pair(owner, (uint32_t)begin));
+        }
+      }
+    };
+    add_runs(root_children, root_list);
+    vector<uint32_t> by_length(lists.size());
+    for (uint32_t i = 0; i < lists.size(); i++) {
+      by_length[i] = i;
+    }
+    stable_sort(by_length.begin(), by_length.end(), [&](uint32_t a, uint32_t b) {
+      return lists[a].size() > lists[b].size();
+    });
+    for (uint32_t list : by_length) {
+      const vector<uint32_t>& children = lists[list];
+      string key((const char*)children.data(), children.size() * sizeof(children[0]));
+      auto it = runs.find(key);
+      if (it != runs.end()) {
+        owners[list] = it->second.first;
+        owner_offsets[list] = it->second.second;
+      } else {
+        add_runs(children, list);
+      }
+    }
+  }
+
+  // Lists with tracking numbers that don't fit in a byte go first, so that JPA's Part
+  // Three (32-bit tracking numbers) stays short and Part Four (bytes) takes the rest.
+  vector<uint32_t> order;
+  for (uint32_t i = 0; i < lists.size(); i++) {
+    if (owners[i] == i) {
+      order.push_back(i);
+    }
+  }
+  stable_partition(order.begin(), order.end(), [&](uint32_t list) {
+    return list_words[list] >= 255;
+  });
+  vector<uint32_t> list_starts(lists.size() + 1);
+  list_starts[root_list] = 1;
+  for (uint32_t list : order) {
+    list_starts[list] = AppendList(lists[list]);
+  }
+  for (uint32_t s = 0; s < states_.size(); s++) {
+    uint32_t list = state_lists[s];
+    if (list != kNoState) {
+      child_index_[s] = list_starts[owners[list]] + owner_offsets[list];
+      if (owners[list] == root_list) {
+        top_level_runs_.push_back(s);
+      }
+    }
+  }
+  for (const auto& [key, list] : list_ids) {
+    list_starts_.emplace(key, list_starts[owners[list]] + owner_offsets[list]);
+  }
+}
+
+void AdtdawgBuilder::LayoutPatch() {
+  child_index_.resize(states_.size(), 0);
+
+  // The top level list stays at 1..A and is rewritten in place.
+  vector<uint32_t> root_children = RootChildren();
+  uint32_t tracking = 0;
+  for (size_t i = root_children.size(); i-- > 0;) {
+    uint32_t s = root_children[i];
+    if (s != kNoState) {
+      tracking += states_[s].words_under;
+    }
+    entries_[1 + i] = {s, tracking};
+  }
+
+  // A list that was a run of the old top level list is still correct if it covers the
+  // same states, since tracking numbers are only ever compared within a run.
+  vector<uint32_t> runs;
+  runs.swap(top_level_runs_);
+  for (uint32_t s : runs) {
+    if (ListMatches(s, child_index_[s])) {
+      top_level_runs_.push_back(s);
+    } else {
+      child_index_[s] = 0;
+    }
+  }
+  for (uint32_t s : root_children) {
+    PlaceList(s);
+  }
+  for (uint32_t s : runs) {
+    PlaceList(s);
+  }
+}
+
+void AdtdawgBuilder::PlaceList(uint32_t s) {
+  if (s == kNoState || child_index_[s] || states_[s].children.empty()) {
+    return;
+  }
+  // States that already have a list only have children with lists, so this only
+  // visits the states created by the patch.
+  string key = ListKey(s);
+  auto it = list_starts_.find(key);
+  if (it != list_starts_.end() && ListMatches(s, it->second)) {
+    child_index_[s] = it->second;
+  } else {
+    vector<uint32_t> children;
+    for (const auto& [letter, child] : states_[s].children) {
+      children.push_back(child);
+    }
+    child_index_[s] = AppendList(children);
+    list_starts_[key] = child_index_[s];
+  }
+  if (child_index_[s] <= alphabet_.size()) {
+    top_level_runs_.push_back(s);
+  }
+  for (const auto& [letter, child] : states_[s].children) {
+    PlaceList(child);
+  }
+}
+
+unique_ptr<Adtdawg> AdtdawgBuilder::BuildChildMask() {
+  Layout();
+  uint32_t num_nodes = entries_.size() - 1;
+  auto dawg = Adtdawg::Allocate(
+      kChildMaskEncoding,
+      alphabet_.c_str(),
+      num_nodes,
+      0,
+      states_[root_].words_under
+  );
+  if (!dawg.get()) {
+    return NULL;
+  }
+
+  WideNode* nodes = dawg->MutableWideNodes();
+  uint32_t* tracking = dawg->MutableTracking();
+  for (uint32_t i = 1; i <= num_nodes; i++) {
+    const Entry& entry = entries_[i];
+    tracking[i] = entry.tracking;
+    if (entry.state == kNoState) {
+      continue;
+    }
+    const State& state = states_[entry.state];
+    nodes[i].child_index = child_index_[entry.state];
+    nodes[i].is_word = state.is_word;
+    nodes[i].child_mask = state.child_mask;
+  }
+  return dawg;
+}
+
+unique_ptr<Adtdawg> AdtdawgBuilder::BuildPartTwo() {
+  if (alphabet_.size() > kMaxPartTwoLetters) {
+    fprintf(
+        stderr,
+        "Part Two holds at most %zu letters, not %zu\n",
+        kMaxPartTwoLetters,
+        alphabet_.size()
+    );
+    return NULL;
+  }
+  if (Layout() && entries_.size() - 1 > kMaxPartTwoNodes) {
+    // Nodes left unused by earlier patches may be all that doesn't fit.
+    LayoutAll();
+  }
+  uint32_t num_nodes = entries_.size() - 1;
+  if (num_nodes > kMaxPartTwoNodes) {
+    fprintf(
+        stderr,
+        "%u nodes don't fit in Part One (at most %u)\n",
+        num_nodes,
+        kMaxPartTwoNodes
+    );
+    return NULL;
+  }
+
+  // Every distinct set of child letters gets one Part Two entry.  Entry 0 is for nodes
+  // without children.
+  vector<uint64_t> child_offsets(1, 0);
+  unordered_map<uint32_t, uint32_t> offset_indices = {{0, 0}};
+  vector<uint32_t> node_offset_indices(num_nodes + 1, 0);
+  for (uint32_t i = 1; i <= num_nodes; i++) {
+    if (entries_[i].state == kNoState) {
+      continue;
+    }
+    uint32_t child_mask = states_[entries_[i].state].child_mask;
+    auto it = offset_indices.find(child_mask);
+    if (it == offset_indices.end()) {
+      it = offset_indices.emplace(child_mask, child_offsets.size()).first;
+      child_offsets.push_back(PartTwoEntry(child_mask, alphabet_.size()));
+    }
+    node_offset_indices[i] = it->second;
+  }
+  if (child_offsets.size() > kMaxPartTwoEntries) {
+    fprintf(
+        stderr,
+        "%zu Part Two entries don't fit in Part One (at most %u)\n",
+        child_offsets.size(),
+        kMaxPartTwoEntries
+    );
+    return NULL;
+  }
+
+  auto dawg = Adtdawg::Allocate(
+      kPartTwoEncoding,
+      alphabet_.c_str(),
+      num_nodes,
+      child_offsets.size(),
+      states_[root_].words_under
+  );
+  if (!dawg.get()) {
+    return NULL;
+  }
+
+  Node* nodes = dawg->MutableNodes();
+  uint32_t* tracking = dawg->MutableTracking();
+  copy(child_offsets.begin(), child_offsets.end(), dawg->MutableChildOffsets());
+  if (!dawg->BuildPartTwoMasks()) {
+    return NULL;
+  }
+  for (uint32_t i = 1; i <= num_nodes; i++) {
+    const Entry& entry = entries_[i];
+    tracking[i] = entry.tracking;
+    if (entry.state == kNoState) {
+      continue;
+    }
+    nodes[i].child_index = child_index_[entry.state];
+    nodes[i].offset_index = node_offset_indices[i];
+    nodes[i].is_word = states_[entry.state].is_word;
+  }
+  return dawg;
+}
@@ -0,0 +1,158 @@
+// Builds ADTDAWGs from word lists.
+//
+// The words are first merged into a minimal DAWG by hashing: two states are equivalent
+// when they agree on is_word and on their (letter, child state) edges, so each state is
+// interned bottom up and equivalent states are only ever created once.
+//
+// The ADTDAWG is then laid out from that DAWG.  Each state with children gets a child
+// list, and states whose children are the same sequence of states share one list.  A
+// list that is a contiguous run of a longer list is shared too, by pointing into the
+// middle of the longer one.  A Part One node is an entry in a list: it points at the
+// child list of its state and carries the "words to end of branch list" tracking number
+// for its position.
+//
+// A built ADTDAWG can be patched without starting over.  FromAdtdawg recovers the DAWG
+// from an image, and words added or removed after a build only replace the states on
+// their own paths.  The next build keeps the existing node array and appends child
+// lists for the new states, so its cost depends on the size of the patch rather than
+// the lexicon.  Nodes no longer reachable from the root are left in place until
+// Compact() asks for a fresh layout.
+//
+// This replaces JPA's two ADTDAWG_Creator programs, which needed a prepared lexicon
+// file, exchanged intermediate .dat files and compared nodes pairwise.
+#ifndef ADTDAWG_BUILDER_H
+#define ADTDAWG_BUILDER_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "adtdawg.h"
+
+class AdtdawgBuilder {
+ public:
+  // "alphabet" lists the upper case letters of the lexicon, in child list order.
+  // Words longer than "max_length" letters are skipped; zero means no limit.
+  explicit AdtdawgBuilder(const std::string& alphabet, size_t max_length = 0);
+  // Recovers the DAWG and node layout of "dawg" so that it can be patched.  Every node
+  // is decoded and interned, so this takes time in proportion to the ADTDAWG.  Returns
+  // NULL if the ADTDAWG isn't well formed.
+  static std::unique_ptr<AdtdawgBuilder> FromAdtdawg(
+      const Adtdawg& dawg, size_t max_length = 0
+  );
+
+  // Adds every word from a file with one word per line.  Words are converted to Boggle
+  // words ("qu" becomes "q") and anything with letters outside the alphabet is skipped.
+  // Returns false if the file can't be read.
+  bool AddWordsFromFile(const char* filename);
+  // Reads a patch: one word per line, prefixed with "-" to remove it or optionally "+"
+  // to add it.  Lines are applied in order.  Returns false if the file can't be read.
+  bool AddPatchFromFile(const char* filename);
+  // Adds one upper case Boggle word.  Returns false if it has letters outside the
+  // alphabet.
+  bool AddWord(const std::string& word);
+  // Removes one upper case Boggle word, if it is in the lexicon at the next build.
+  // Returns false if it has letters outside the alphabet.
+  bool RemoveWord(const std::string& word);
+  // Makes the next build lay out every child list afresh, dropping unused nodes.
+  void Compact() { relayout_ = true; }
+
+  // Builds an ADTDAWG using the child mask encoding.
+  std::unique_ptr<Adtdawg> BuildChildMask();
+  // Builds an ADTDAWG using JPA's Part Two encoding, which can be written out as his
+  // four .dat files.  Returns NULL if the lexicon doesn't fit: Part Two holds at most
+  // kMaxPartTwoLetters letters, and Part One's bit fields at most 32767 nodes and 2048
+  // Part Two entries.  A patched layout that runs out of nodes is compacted first.
+  std::unique_ptr<Adtdawg> BuildPartTwo();
+
+  // Sublist sharing is on by default; turning it off only shares identical lists.
+  void SetSublistSharing(bool share) { sublist_sharing_ = share; }
+
+  // Number of words as of the last build.
+  size_t NumWords() const { return states_.empty() ? 0 : states_[root_].words_under; }
+  // Number of distinct DAWG states from the last build, including any replaced by
+  // patches since the DAWG was built from scratch.
+  size_t NumStates() const { return states_.size(); }
+  // Words that the last build actually added and removed.
+  size_t NumWordsAdded() const { return words_added_; }
+  size_t NumWordsRemoved() const { return words_removed_; }
+
+ private:
+  struct State {
+    bool is_word;
+    uint32_t words_under;
+    uint32_t child_mask;
+    std::vector<std::pair<uint8_t, uint32_t>> children;  // (letter, state) by letter
+  };
+
+  // One Part One node: an entry in a child list.
+  struct Entry {
+    uint32_t state;  // kNoState for letters that start no words at the top level
+    uint32_t tracking;
+  };
+
+  static constexpr uint32_t kNoState = 0xffffffff;
+  // Limits of JPA's encoding: 64-bit Part Two entries and the 15 and 11 bit Part One
+  // fields that index the nodes and Part Two.
+  static constexpr size_t kMaxPartTwoLetters = 18;
+  static constexpr uint32_t kMaxPartTwoNodes = (1 << 15) - 1;
+  static constexpr uint32_t kMaxPartTwoEntries = 1 << 11;
+
+  static uint64_t PartTwoEntry(uint32_t child_mask, size_t alphabet_size);
+  // Converts a word from a file to an upper case Boggle word in place.
+  static bool ToBoggleWord(char* word);
+  // Converts an upper case word to letter indices.
+  bool ToIndices(const std::string& word, std::string* indices) const;
+
+  uint32_t BuildStates(size_t begin, size_t end, size_t depth);
+  uint32_t Intern(State&& state);
+  // Returns the state that replaces "s" (kNoState for no words) once the suffix
+  // "word[depth:]" is added to or removed from it.
+  uint32_t PatchState(uint32_t s, const std::string& word, size_t depth, bool add);
+  // Builds the DAWG if needed, applies the pending patch and lays out the child lists.
+  // Fills in "entries_" (indexed like Part One) and the first child index of every
+  // state.  Returns true if an existing layout was extended rather than replaced.
+  bool Layout();
+  // Lays out every child list reachable from the root, starting from an empty array.
+  void LayoutAll();
+  // Rewrites the top level list and appends child lists for states without one.
+  void LayoutPatch();
+  // Points "s" at a list of its children, reusing an identical list if there is one,
+  // then does the same for its children.
+  void PlaceList(uint32_t s);
+  // Returns the key identifying the list of s's children.
+  std::string ListKey(uint32_t s) const;
+  // True if the entries at "start" are s's children.
+  bool ListMatches(uint32_t s, uint32_t start) const;
+  // Appends "states" to "entries_" as one list and returns its start.
+  uint32_t AppendList(const std::vector<uint32_t>& states);
+  std::vector<uint32_t> RootChildren() const;
+
+  std::string alphabet_;
+  size_t max_length_;
+  bool sublist_sharing_;
+  int letter_indices_[26];
+  std::vector<std::string> words_;  // as strings of letter indices, before the build
+  // Words to add (true) or remove (false) once the DAWG is built, in order.
+  std::vector<std::pair<std::string, bool>> patch_;
+  bool relayout_;
+  size_t words_added_;
+  size_t words_removed_;
+
+  std::vector<State> states_;
+  std::unordered_map<std::string, uint32_t> registry_;
+  uint32_t root_;
+  std::vector<Entry> entries_;
+  std::vector<uint32_t> child_index_;  // by state, zero until the state is placed
+  // Start of a placed list by ListKey, for reuse by new states.  Entries are checked
+  // before use, since the top level list is rewritten in place.
+  std::unordered_map<std::string, uint32_t> list_starts_;
+  // States whose lists are runs of the top level list.
+  std::vector<uint32_t> top_level_runs_;
+};
+
+#endif  // ADTDAWG_BUILDER_H
@@ -0,0 +1,207 @@
+#include "adtdawg_pattern.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <bit>
+
+using namespace std;
+
+PatternSearcher::PatternSearcher(const Adtdawg& dawg)
+    : dawg_(dawg), heights_(dawg.NumNodes() + 1, 0) {
+  for (int i = 0; i < 26; i++) {
+    letter_indices_[i] = -1;
+  }
+  for (size_t i = 0; i < dawg.Alphabet().size(); i++) {
+    letter_indices_[dawg.Alphabet()[i] - 'A'] = i;
+  }
+
+  // Each node's height comes from its children's, so they are filled in first.
+  vector<bool> done(dawg.NumNodes() + 1, false);
+  auto height = [&](auto& self, uint32_t node) -> uint8_t {
+    if (done[node]) {
+      return heights_[node];
+    }
+    uint32_t first_child = dawg_.FirstChild(node);
+    uint32_t num_children = popcount(dawg_.ChildMask(node));
+    uint8_t h = 0;
+    for (uint32_t i = 0; i < num_children; i++) {
+      h = max<uint8_t>(h, self(self, first_child + i) + 1);
+    }
+    done[node] = true;
+    heights_[node] = h;
+    return h;
+  };
+  for (uint32_t node = 1; node <= dawg.NumNodes(); node++) {
+    height(height, node);
+  }
+}
+
+bool PatternSearcher::Parse(const string& pattern, Query* query) const {
+  uint32_t all_letters = (1u << dawg_.Alphabet().size()) - 1;
+  // The letters each element matches; "*" is kRun, which no letter or class can be.
+  const uint32_t kRun = ~0u;
+  vector<uint32_t> elements;
+  query->matches_nothing = false;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    char c = toupper(pattern[i]);
+    uint32_t letters = 0;
+    if (c == '*') {
+      // A run next to another run adds nothing.
+      if (elements.empty() || elements.back() != kRun) {
+        elements.push_back(kRun);
+      }
+      continue;
+    } else if (c == '?') {
+      letters = all_letters;
+    } else if (c == '[') {
+      size_t end = pattern.find(']', i + 1);
+      if (end == string::npos) {
+        fprintf(stderr, "Unterminated letter class in %s\n", pattern.c_str());
+        return false;
+      }
+      bool negate = i + 1 < end && pattern[i + 1] == '^';
+      for (size_t j = i + 1 + negate; j < end; j++) {
+        char first = toupper(pattern[j]);
+        char last = first;
+        if (j + 2 < end && pattern[j + 1] == '-') {
+          last = toupper(pattern[j + 2]);
+          j += 2;
+        }
+        if (first < 'A' || last > 'Z' || first > last) {
+          fprintf(stderr, "Bad letter class in %s\n", pattern.c_str());
+          return false;
+        }
+        for (char l = first; l <= last; l++) {
+          if (letter_indices_[l - 'A'] >= 0) {
+            letters |= 1u << letter_indices_[l - 'A'];
+          }
+        }
+      }
+      if (negate) {
+        letters = all_letters & ~letters;
+      }
+      i = end;
+    } else if (c >= 'A' && c <= 'Z') {
+      if (letter_indices_[c - 'A'] >= 0) {
+        letters = 1u << letter_indices_[c - 'A'];
+      }
+      if (c == 'Q' && i + 1 < pattern.size() && toupper(pattern[i + 1]) == 'U') {
+        i++;
+      }
+    } else {
+      fprintf(stderr, "Unexpected '%c' in %s\n", pattern[i], pattern.c_str());
+      return false;
+    }
+    // A letter outside the alphabet, or a class with none of its letters, matches
+    // nothing, and neither does the pattern.
+    if (!letters) {
+      query->matches_nothing = true;
+    }
+    elements.push_back(letters);
+  }
+  if (elements.size() > kMaxPatternElements) {
+    fprintf(
+        stderr, "%s has more than %zu parts\n", pattern.c_str(), kMaxPatternElements
+    );
+    return false;
+  }
+
+  query->runs = 0;
+  memset(query->matches, 0, sizeof(query->matches));
+  query->letters_needed[elements.size()] = 0;
+  for (size_t i = elements.size(); i-- > 0;) {
+    query->letters_needed[i] = query->letters_needed[i + 1] + (elements[i] != kRun);
+    if (elements[i] == kRun) {
+      query->runs |= 1ull << i;
+      continue;
+    }
+    for (size_t letter = 0; letter < dawg_.Alphabet().size(); letter++) {
+      if (elements[i] & (1u << letter)) {
+        query->matches[letter] |= 1ull << i;
+      }
+    }
+  }
+  query->accept = 1ull << elements.size();
+  return true;
+}
+
+bool PatternSearcher::Search(
+    const string& pattern,
+    uint32_t min_length,
+    uint32_t max_length,
+    const Callback& found
+) const {
+  Query query;
+  if (!Parse(pattern, &query)) {
+    return false;
+  }
+  query.min_length = min_length;
+  query.max_length = max_length;
+  query.found = &found;
+  if (query.matches_nothing) {
+    return true;
+  }
+
+  // The top level nodes act as the root's children.
+  uint64_t start = Close(query, 1);
+  string word;
+  for (uint32_t letter = 0; letter < dawg_.Alphabet().size(); letter++) {
+    uint64_t states = Advance(query, start, letter);
+    uint32_t node = letter + 1;
+    if (states && (dawg_.IsWord(node) || dawg_.FirstChild(node))) {
+      Walk(query, letter, node, dawg_.Tracking()[node], states, &word);
+    }
+  }
+  return true;
+}
+
+void PatternSearcher::Walk(
+    const Query& query,
+    uint32_t letter,
+    uint32_t node,
+    uint32_t word_index,
+    uint64_t states,
+    string* word
+) const {
+  // Pattern positions only move forward, so the furthest one needs the fewest letters.
+  uint32_t furthest = 63 - countl_zero(states);
+  if (heights_[node] < query.letters_needed[furthest]) {
+    return;
+  }
+  size_t word_length = word->size();
+  char c = dawg_.Alphabet()[letter];
+  word->push_back(c);
+  if (c == 'Q') {
+    word->push_back('U');
+  }
+  uint32_t length = word->size();
+
+  bool short_enough = !query.max_length || length <= query.max_length;
+  if (dawg_.IsWord(node) && (states & query.accept) && length >= query.min_length &&
+      short_enough) {
+    (*query.found)(word_index, *word);
+  }
+  uint32_t first_child = dawg_.FirstChild(node);
+  if (first_child && short_enough) {
+    uint32_t child_mask = dawg_.ChildMask(node);
+    for (uint32_t mask = child_mask; mask; mask &= mask - 1) {
+      uint32_t next_letter = countr_zero(mask);
+      uint64_t next_states = Advance(query, states, next_letter);
+      if (!next_states) {
+        continue;
+      }
+      uint32_t child = first_child + popcount(child_mask & ((1u << next_letter) - 1));
+      Walk(
+          query,
+          next_letter,
+          child,
+          dawg_.ChildWordIndex(node, word_index, child),
+          next_states,
+          word
+      );
+    }
+  }
+  word->resize(word_length);
+}
@@ -0,0 +1,91 @@
+// Finds the words in an ADTDAWG that match a crossword-style pattern.
+//
+// A pattern is a sequence of:
+//   - a letter, which matches itself,
+//   - "?", which matches any one letter,
+//   - "*", which matches any run of letters, including none,
+//   - a class such as "[AEIOU]", "[A-F]" or "[^AEIOU]", which matches one letter in
+//     (or, with "^", not in) the class.
+// Case doesn't matter.  The lexicons here are Boggle lexicons, so "QU" in a pattern is
+// the lexicon's "Q," and "?" or a class with Q in it can match "QU."
+//
+// The search walks the ADTDAWG once, carrying the set of pattern positions that the
+// prefix so far can be at, so a prefix that can't match prunes its whole subtree.  It
+// also knows the longest word below every node and stops when the pattern needs more
+// letters than that.  Every word is reached by exactly one path, so each match is
+// reported once, with its word id from the tracking numbers.
+#ifndef ADTDAWG_PATTERN_H
+#define ADTDAWG_PATTERN_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "adtdawg.h"
+
+class PatternSearcher {
+ public:
+  // Called with the id and spelling of each matching word, in alphabetical order.
+  typedef std::function<void(uint32_t word_id, const std::string& word)> Callback;
+
+  // Patterns can have at most this many letters, classes and runs.
+  static const size_t kMaxPatternElements = 63;
+
+  explicit PatternSearcher(const Adtdawg& dawg);
+
+  // Calls "found" for every word matching "pattern" that is between min_length and
+  // max_length letters long ("QU" counts as two; a max_length of zero is no limit).
+  // Returns false if the pattern can't be parsed.
+  bool Search(
+      const std::string& pattern,
+      uint32_t min_length,
+      uint32_t max_length,
+      const Callback& found
+  ) const;
+
+ private:
+  // The pattern compiled for one search.  Bit i of a state set is set when the prefix
+  // so far could be followed by pattern element i onwards; bit "size" means the whole
+  // pattern has matched.
+  struct Query {
+    uint64_t runs;                       // elements that are "*"
+    uint64_t matches[kMaxAlphabetSize];  // letter elements matching each letter
+    // The number of elements from i on that aren't "*"
+    uint32_t letters_needed[kMaxPatternElements + 1];
+    uint64_t accept;
+    // Some letter or class matches no letter of the alphabet.
+    bool matches_nothing;
+    uint32_t min_length;
+    uint32_t max_length;
+    const Callback* found;
+  };
+
+  bool Parse(const std::string& pattern, Query* query) const;
+  // Adds the positions after each "*" the set could be at, since a run can be empty.
+  static uint64_t Close(const Query& query, uint64_t states) {
+    return states | (states & query.runs) << 1;
+  }
+  // Returns the states after "letter."
+  static uint64_t Advance(const Query& query, uint64_t states, uint32_t letter) {
+    return Close(query, (states & query.matches[letter]) << 1 | (states & query.runs));
+  }
+  // Appends "letter" to "word" and reports and searches below "node," which it leads
+  // to.  "states" is the state set after the letter.
+  void Walk(
+      const Query& query,
+      uint32_t letter,
+      uint32_t node,
+      uint32_t word_index,
+      uint64_t states,
+      std::string* word
+  ) const;
+
+  const Adtdawg& dawg_;
+  int letter_indices_[26];
+  // The most letters on any path down from each node.
+  std::vector<uint8_t> heights_;
+};
+
+#endif  // ADTDAWG_PATTERN_H
@@ -0,0 +1,184 @@
+#include "board_set.h"
+
+using namespace std;
+
+namespace {
+
+const size_t kInitialSlots = 64;
+
+// The eight rotations and reflections of a 5x5 board: symmetries[s][i] is the cell
+// that lands on cell i under symmetry s.
+struct Symmetries {
+  int cells[8][kBoardCells];
+
+  Symmetries() {
+    for (int r = 0; r < 5; r++) {
+      for (int c = 0; c < 5; c++) {
+        int sources[8][2] = {
+            {r, c},
+            {c, 4 - r},
+            {4 - r, 4 - c},
+            {4 - c, r},
+            {r, 4 - c},
+            {4 - r, c},
+            {c, r},
+            {4 - c, 4 - r},
+        };
+        for (int s = 0; s < 8; s++) {
+          cells[s][r * 5 + c] = sources[s][0] * 5 + sources[s][1];
+        }
+      }
+    }
+  }
+};
+
+}  // namespace
+
+PackedBoard PackBoard(const char* board) {
+  PackedBoard packed = {0, 0};
+  for (int i = 0; i < kBoardCells; i++) {
+    packed.SetLetter(i, board[i]);
+  }
+  return packed;
+}
+
+string UnpackBoard(const PackedBoard& board) {
+  string letters(kBoardCells, ' ');
+  for (int i = 0; i < kBoardCells; i++) {
+    letters[i] = board.Letter(i);
+  }
+  return letters;
+}
+
+void UnpackBoard(const PackedBoard& board, char* letters) {
+  for (int i = 0; i < kBoardCells; i++) {
+    letters[i] = board.Letter(i);
+  }
+  letters[kBoardCells] = '\0';
+}
+
+PackedBoard CanonicalBoard(const char* board) {
+  return CanonicalBoard(PackBoard(board));
+}
+
+PackedBoard CanonicalBoard(const PackedBoard& board) {
+  static const Symmetries symmetries;
+  PackedBoard best = board;
+  for (int s = 1; s < 8; s++) {
+    PackedBoard packed = {0, 0};
+    for (int i = 0; i < kBoardCells; i++) {
+      packed.SetLetter(i, board.Letter(symmetries.cells[s][i]));
+    }
+    if (packed < best) {
+      best = packed;
+    }
+  }
+  return best;
+}
+
+BoardSet::BoardSet() : slots_(kInitialSlots, PackedBoard{0, 0}), size_(0) {}
+
+bool BoardSet::Insert(const PackedBoard& board) {
+  if ((size_ + 1) * 4 > slots_.size() * 3) {
+    Grow();
+  }
+  size_t mask = slots_.size() - 1;
+  for (size_t i = board.Hash() & mask;; i = (i + 1) & mask) {
+    if (slots_[i].IsEmpty()) {
+      slots_[i] = board;
+      size_++;
+      return true;
+    }
+    if (slots_[i] == board) {
+      return false;
+    }
+  }
+}
+
+bool BoardSet::Contains(const PackedBoard& board) const {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = board.Hash() & mask;; i = (i + 1) & mask) {
+    if (slots_[i].IsEmpty()) {
+      return false;
+    }
+    if (slots_[i] == board) {
+      return true;
+    }
+  }
+}
+
+vector<PackedBoard> BoardSet::Boards() const {
+  vector<PackedBoard> boards;
+  boards.reserve(size_);
+  for (const auto& slot : slots_) {
+    if (!slot.IsEmpty()) {
+      boards.push_back(slot);
+    }
+  }
+  return boards;
+}
+
+void BoardSet::Grow() {
+  vector<PackedBoard> old_slots(slots_.size() * 2, PackedBoard{0, 0});
+  old_slots.swap(slots_);
+  size_t mask = slots_.size() - 1;
+  for (const auto& board : old_slots) {
+    if (board.IsEmpty()) {
+      continue;
+    }
+    size_t i = board.Hash() & mask;
+    while (!slots_[i].IsEmpty()) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = board;
+  }
+}
+
+BoardScoreMap::BoardScoreMap() : slots_(kInitialSlots, Slot{{0, 0}, 0}), size_(0) {}
+
+bool BoardScoreMap::Find(const PackedBoard& board, uint32_t* score) const {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = board.Hash() & mask;; i = (i + 1) & mask) {
+    if (slots_[i].board.IsEmpty()) {
+      return false;
+    }
+    if (slots_[i].board == board) {
+      *score = slots_[i].score;
+      return true;
+    }
+  }
+}
+
+void BoardScoreMap::Insert(const PackedBoard& board, uint32_t score) {
+  if ((size_ + 1) * 4 > slots_.size() * 3) {
+    Grow();
+  }
+  size_t mask = slots_.size() - 1;
+  for (size_t i = board.Hash() & mask;; i = (i + 1) & mask) {
+    if (slots_[i].board.IsEmpty()) {
+      slots_[i] = Slot{board, score};
+      size_++;
+      return;
+    }
+    if (slots_[i].board == board) {
+      slots_[i].score = score;
+      return;
+    }
+  }
+}
+
+void BoardScoreMap::Grow() {
+  vector<Slot> old_slots(slots_.size() * 2, Slot{{0, 0}, 0});
+  old_slots.swap(slots_);
+  size_t mask = slots_.size() - 1;
+  for (const auto& slot : old_slots) {
+    if (slot.board.IsEmpty()) {
+      continue;
+    }
+    size_t i = slot.board.Hash() & mask;
+    while (!slots_[i].board.IsEmpty()) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = slot;
+  }
+}
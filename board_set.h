@@ -0,0 +1,131 @@
+// Compact sets of 5x5 boards for DeepSearch.
+//
+// A PackedBoard holds a board's 25 letters in 128 bits, five bits a letter, so it is
+// trivially copyable and compares and hashes as two integers.  DeepSearch keeps every
+// board this way and only spells boards out to score or print them.  A BoardSet is an
+// open addressing hash set of PackedBoards with linear probing: 16 bytes a slot and no
+// allocation per board, where a std::set<std::string> spends a tree node and a heap
+// allocated string on every board.
+//
+// Rotating or reflecting a board doesn't change its score, so a set can optionally
+// store every board in its canonical form, the smallest packing of its eight
+// symmetries, and treat all of them as one board.
+//
+// A BoardScoreMap is the same table with a score in each slot, for caching scores.
+#ifndef BOARD_SET_H
+#define BOARD_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+const int kBoardCells = 25;
+
+struct PackedBoard {
+  // Cell i is in bits 5i to 5i + 4, counting across "lo" and then "hi."  Letters are
+  // stored as 1 to 26, so no board packs to all zeros.
+  uint64_t lo;
+  uint64_t hi;
+
+  bool operator==(const PackedBoard& other) const {
+    return lo == other.lo && hi == other.hi;
+  }
+  bool operator!=(const PackedBoard& other) const { return !(*this == other); }
+  bool operator<(const PackedBoard& other) const {
+    return hi != other.hi ? hi < other.hi : lo < other.lo;
+  }
+  bool IsEmpty() const { return lo == 0 && hi == 0; }
+
+  // The only code that knows the packing.  Working on the two words rather than on
+  // Bits() makes CanonicalBoard twice as fast.  Cell 12 straddles the words.
+  char Letter(int cell) const {
+    int bit = 5 * cell;
+    uint64_t letter = bit < 64 ? lo >> bit : hi >> (bit - 64);
+    if (bit > 59 && bit < 64) {
+      letter |= hi << (64 - bit);
+    }
+    return 'A' - 1 + (int)(letter & 0x1f);
+  }
+  void SetLetter(int cell, char letter) {
+    int bit = 5 * cell;
+    uint64_t value = letter - 'A' + 1;
+    if (bit < 64) {
+      lo = (lo & ~(0x1full << bit)) | value << bit;
+      if (bit > 59) {
+        hi = (hi & ~(0x1full >> (64 - bit))) | value >> (64 - bit);
+      }
+    } else {
+      hi = (hi & ~(0x1full << (bit - 64))) | value << (bit - 64);
+    }
+  }
+  unsigned __int128 Bits() const { return (unsigned __int128)hi << 64 | lo; }
+
+  uint64_t Hash() const {
+    uint64_t h = lo ^ (hi * 0x9e3779b97f4a7c15ull);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
+// Packs the first kBoardCells letters of "board," which must be upper case.
+PackedBoard PackBoard(const char* board);
+std::string UnpackBoard(const PackedBoard& board);
+// Writes the board's kBoardCells letters and a terminating NUL to "letters."
+void UnpackBoard(const PackedBoard& board, char* letters);
+// Returns the smallest packing of the board's rotations and reflections.
+PackedBoard CanonicalBoard(const char* board);
+PackedBoard CanonicalBoard(const PackedBoard& board);
+
+class BoardSet {
+ public:
+  BoardSet();
+
+  // Returns true if "board" wasn't already in the set.
+  bool Insert(const PackedBoard& board);
+  bool Contains(const PackedBoard& board) const;
+
+  size_t Size() const { return size_; }
+  // Memory used by the table.
+  size_t Bytes() const { return slots_.capacity() * sizeof(PackedBoard); }
+  // The boards in the set, in no particular order.
+  std::vector<PackedBoard> Boards() const;
+
+ private:
+  // Doubles the table, which is kept under three quarters full.
+  void Grow();
+
+  std::vector<PackedBoard> slots_;  // empty slots are all zeros
+  size_t size_;
+};
+
+// A score for each board, laid out like a BoardSet.  Scores don't change under
+// rotation or reflection, so a cache keyed by canonical boards is shared by all eight.
+class BoardScoreMap {
+ public:
+  BoardScoreMap();
+
+  // Returns false if "board" isn't in the map.
+  bool Find(const PackedBoard& board, uint32_t* score) const;
+  // Sets the score of "board," adding it if it's new.
+  void Insert(const PackedBoard& board, uint32_t score);
+
+  size_t Size() const { return size_; }
+  size_t Bytes() const { return slots_.capacity() * sizeof(Slot); }
+
+ private:
+  struct Slot {
+    PackedBoard board;
+    uint32_t score;
+  };
+
+  void Grow();
+
+  std::vector<Slot> slots_;  // empty slots have all-zero boards
+  size_t size_;
+};
+
+#endif  // BOARD_SET_H
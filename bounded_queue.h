@@ -0,0 +1,57 @@
+// A fixed-capacity, blocking, multi-producer/multi-consumer queue.
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// Items are stored in a ring buffer of "capacity" slots.  Push() blocks while the
+// queue is full and Pop() blocks while it is empty, so a fast producer can never run
+// more than "capacity" items ahead of its consumers.
+template <typename T>
+class BoundedQueue {
+ public:
+  BoundedQueue(size_t capacity)
+      : ring_(capacity), head_(0), size_(0), closed_(false) {}
+
+  void Push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return size_ < ring_.size(); });
+    ring_[(head_ + size_) % ring_.size()] = std::move(item);
+    size_++;
+    not_empty_.notify_one();
+  }
+
+  // Returns false once the queue has been closed and drained.
+  bool Pop(T* item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return size_ > 0 || closed_; });
+    if (size_ == 0) {
+      return false;
+    }
+    *item = std::move(ring_[head_]);
+    head_ = (head_ + 1) % ring_.size();
+    size_--;
+    not_full_.notify_one();
+    return true;
+  }
+
+  // No more items will be pushed; wakes up every blocked consumer.
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+ private:
+  std::vector<T> ring_;
+  size_t head_;
+  size_t size_;
+  bool closed_;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+#endif  // BOUNDED_QUEUE_H
@@ -0,0 +1,165 @@
+#include "checkpoint.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "search_codec.h"
+
+using namespace std;
+
+namespace {
+
+const char kCheckpointMagic[8] = {'D', 'S', 'C', 'H', 'K', 'P', 'T', '\0'};
+// Version 2 added the dictionary to the search parameters.
+const uint32_t kCheckpointVersion = 2;
+
+double Now() {
+  return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+bool WriteCheckpoint(const char* filename, SearchCheckpoint* checkpoint) {
+  SearchEncoder out;
+  out.bytes.assign(kCheckpointMagic, kCheckpointMagic + 8);
+  out.Varint(kCheckpointVersion);
+  out.Parameters(checkpoint->parameters);
+  out.Varint(checkpoint->seeds_started);
+  out.Scores(checkpoint->master_list);
+  out.Varint(checkpoint->chosen_seeds.size());
+  for (const auto& seed : checkpoint->chosen_seeds) {
+    out.Board(seed);
+  }
+  out.Varint(checkpoint->running_seeds.size());
+  for (const auto& progress : checkpoint->running_seeds) {
+    out.Progress(progress);
+  }
+
+  auto& evaluated = checkpoint->evaluated;
+  sort(evaluated.begin(), evaluated.end());
+  out.Varint(evaluated.size());
+  unsigned __int128 previous = 0;
+  for (const auto& board : evaluated) {
+    out.Varint(BoardToInteger(board) - previous);
+    previous = BoardToInteger(board);
+  }
+
+  string tmp_filename = string(filename) + ".tmp";
+  FILE* f = fopen(tmp_filename.c_str(), "wb");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", tmp_filename.c_str());
+    return false;
+  }
+  bool ok = fwrite(out.bytes.data(), 1, out.bytes.size(), f) == out.bytes.size();
+  ok = fflush(f) == 0 && fsync(fileno(f)) == 0 && ok;
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp_filename.c_str(), filename) != 0) {
+    fprintf(stderr, "Couldn't write %s\n", filename);
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ReadCheckpoint(const char* filename, SearchCheckpoint* checkpoint) {
+  FILE* f = fopen(filename, "rb");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", filename);
+    return false;
+  }
+  vector<uint8_t> bytes;
+  uint8_t buffer[1 << 16];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + n);
+  }
+  fclose(f);
+  if (bytes.size() < 8 || memcmp(bytes.data(), kCheckpointMagic, 8) != 0) {
+    fprintf(stderr, "%s is not a DeepSearch checkpoint\n", filename);
+    return false;
+  }
+  SearchDecoder in(bytes.data() + 8, bytes.size() - 8);
+  uint32_t version = in.Varint();
+  if (version != kCheckpointVersion) {
+    fprintf(
+        stderr, "Checkpoint version %u, expected %u\n", version, kCheckpointVersion
+    );
+    return false;
+  }
+
+  checkpoint->parameters = in.Parameters();
+  checkpoint->seeds_started = in.Varint();
+  checkpoint->master_list = in.Scores();
+  checkpoint->chosen_seeds.clear();
+  size_t num_chosen = in.Count();
+  for (size_t i = 0; i < num_chosen && in.Ok(); i++) {
+    checkpoint->chosen_seeds.push_back(in.Board());
+  }
+  checkpoint->running_seeds.clear();
+  size_t num_running = in.Count();
+  for (size_t i = 0; i < num_running && in.Ok(); i++) {
+    checkpoint->running_seeds.push_back(in.Progress());
+  }
+
+  checkpoint->evaluated.clear();
+  size_t num_evaluated = in.Count();
+  checkpoint->evaluated.reserve(num_evaluated);
+  unsigned __int128 previous = 0;
+  for (size_t i = 0; i < num_evaluated && in.Ok(); i++) {
+    previous += in.Varint();
+    checkpoint->evaluated.push_back(IntegerToBoard(previous));
+  }
+
+  if (!in.Ok() || !in.AtEnd()) {
+    fprintf(stderr, "Checkpoint %s is corrupt\n", filename);
+    return false;
+  }
+  return true;
+}
+
+CheckpointWriter::CheckpointWriter(const string& filename, double interval)
+    : filename_(filename), interval_(interval), last_time_(Now()), done_(false) {
+  thread_ = thread(&CheckpointWriter::Run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    lock_guard<mutex> lock(lock_);
+    done_ = true;
+  }
+  waiting_.notify_one();
+  thread_.join();
+}
+
+bool CheckpointWriter::Due() const {
+  lock_guard<mutex> lock(lock_);
+  return Now() - last_time_ >= interval_;
+}
+
+void CheckpointWriter::Write(unique_ptr<SearchCheckpoint> checkpoint) {
+  {
+    lock_guard<mutex> lock(lock_);
+    next_ = std::move(checkpoint);
+    last_time_ = Now();
+  }
+  waiting_.notify_one();
+}
+
+void CheckpointWriter::Run() {
+  unique_lock<mutex> lock(lock_);
+  for (;;) {
+    waiting_.wait(lock, [this] { return next_ || done_; });
+    if (!next_) {
+      return;
+    }
+    auto checkpoint = std::move(next_);
+    lock.unlock();
+    WriteCheckpoint(filename_.c_str(), checkpoint.get());
+    lock.lock();
+  }
+}
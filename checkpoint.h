@@ -0,0 +1,111 @@
+// Checkpoints of a DeepSearch run, so that a long search can survive restarts.
+//
+// A checkpoint holds everything the search keeps in memory: the master list, the seeds
+// chosen so far (in the order they were chosen), the boards that have been evaluated,
+// and for each seed still running, the round it has reached and its evaluate list.
+//
+// The file is compact and binary.  Integers are varints and boards are PackedBoards.
+// The evaluated boards, which are most of the file, are sorted and stored as varint
+// deltas from the board before; boards found near each other in a search share most
+// of their letters, so the deltas are often much shorter than a full board.
+//
+// CheckpointWriter writes checkpoints on a background thread.  Each one goes to a
+// temporary file that is renamed over the old checkpoint, so a crash mid-write leaves
+// the previous checkpoint intact.
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board_set.h"
+#include "insert.h"
+
+// The search parameters a checkpoint was made with.  A run can only resume from a
+// checkpoint made with the same ones, except that the number of seeds can change.
+struct SearchParameters {
+  uint32_t rounds;
+  uint32_t boards_per_round;
+  uint32_t evaluate_list_size;
+  uint32_t master_list_size;
+  bool canonical;
+  std::string character_set;
+  // Which dictionary the scores come from, as ScorerPool's NumWords() and
+  // DictionaryHash(), so that scores from different word lists are never mixed.
+  uint32_t dictionary_words;
+  uint64_t dictionary_hash;
+
+  bool SameDictionary(const SearchParameters& other) const {
+    return dictionary_words == other.dictionary_words &&
+           dictionary_hash == other.dictionary_hash;
+  }
+  bool operator==(const SearchParameters& other) const {
+    return rounds == other.rounds && boards_per_round == other.boards_per_round &&
+           evaluate_list_size == other.evaluate_list_size &&
+           master_list_size == other.master_list_size &&
+           canonical == other.canonical && character_set == other.character_set &&
+           SameDictionary(other);
+  }
+};
+
+// A seed that was running when the checkpoint was made.
+struct SeedProgress {
+  int seed_number;
+  BoardScore seed;
+  // The next round to run, and the evaluate list it starts from.  The round is -1 if
+  // the seed's own deviations haven't been made yet.
+  int round;
+  std::vector<BoardScore> evaluate_list;
+};
+
+struct SearchCheckpoint {
+  SearchParameters parameters;
+  int seeds_started;
+  std::vector<BoardScore> master_list;
+  std::vector<PackedBoard> chosen_seeds;
+  std::vector<SeedProgress> running_seeds;
+  // As stored in the evaluated set, i.e. canonical if parameters.canonical is set.
+  std::vector<PackedBoard> evaluated;
+};
+
+// Returns false if the checkpoint can't be written.  The checkpoint's evaluated boards
+// are sorted in the process.
+bool WriteCheckpoint(const char* filename, SearchCheckpoint* checkpoint);
+// Returns false if the file can't be read or isn't a checkpoint.
+bool ReadCheckpoint(const char* filename, SearchCheckpoint* checkpoint);
+
+// Writes checkpoints to one file on a background thread.  If a checkpoint arrives while
+// the previous one is still being written, it replaces any checkpoint still waiting,
+// since only the newest one matters.
+class CheckpointWriter {
+ public:
+  // "interval" is the minimum number of seconds between checkpoints.
+  CheckpointWriter(const std::string& filename, double interval);
+  // Waits for any checkpoint in progress or waiting to be written.
+  ~CheckpointWriter();
+
+  // Returns true if the last checkpoint was made at least "interval" seconds ago.
+  bool Due() const;
+  // Queues "checkpoint" to be written.
+  void Write(std::unique_ptr<SearchCheckpoint> checkpoint);
+
+ private:
+  void Run();
+
+  const std::string filename_;
+  const double interval_;
+  mutable std::mutex lock_;
+  std::condition_variable waiting_;
+  std::unique_ptr<SearchCheckpoint> next_;
+  double last_time_;
+  bool done_;
+  std::thread thread_;
+};
+
+#endif  // CHECKPOINT_H
@@ -0,0 +1,15 @@
+#include "command_line.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+bool ParseCount(const char* value, long min, long max, uint32_t* count) {
+  char* end;
+  errno = 0;
+  long n = strtol(value, &end, 10);
+  if (end == value || *end || errno || n < min || n > max) {
+    return false;
+  }
+  *count = n;
+  return true;
+}
@@ -0,0 +1,18 @@
+// Parses the numeric arguments of the command-line tools.
+//
+// atoi() turns "abc" into 0 and "-1" into a huge unsigned count, so a typo in a
+// thread count can mean every core or an allocation failure.  These parse the whole
+// argument and refuse anything that isn't a number in range.
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <stdint.h>
+
+// More worker threads than this is a typo, not a machine.
+const long kMaxThreads = 1024;
+
+// Parses value as a decimal integer in [min, max].  Returns false, leaving *count
+// alone, if value is empty, has anything after the number or is out of range.
+bool ParseCount(const char* value, long min, long max, uint32_t* count);
+
+#endif  // COMMAND_LINE_H
@@ -69,10 +69,14 @@ bool InsertIntoSortedVector(
   return true;
 }
 
-bool InsertIntoMasterList(std::vector<BoardScore> &list, const BoardScore &board) {
-  return InsertIntoSortedVector(list, MASTER_LIST_SIZE, board);
+bool InsertIntoMasterList(
+    std::vector<BoardScore> &list, const BoardScore &board, unsigned int max_size
+) {
+  return InsertIntoSortedVector(list, max_size, board);
 }
 
-bool InsertIntoEvaluateList(std::vector<BoardScore> &list, const BoardScore &board) {
-  return InsertIntoSortedVector(list, EVALUATE_LIST_SIZE, board);
+bool InsertIntoEvaluateList(
+    std::vector<BoardScore> &list, const BoardScore &board, unsigned int max_size
+) {
+  return InsertIntoSortedVector(list, max_size, board);
 }
@@ -1,14 +1,18 @@
 #ifndef INSERT_H
 #define INSERT_H
 
-#include <string>
+#include <type_traits>
 #include <vector>
 
+#include "board_set.h"
+
+// Boards are packed (see board_set.h), so boards and scores copy and compare as a few
+// integers.  They're only spelled out to be scored or printed.
 struct BoardWithCell {
-  std::string board;
+  PackedBoard board;
   int off_limit_cell;
 
-  BoardWithCell(std::string bd, int cell) : board(bd), off_limit_cell(cell) {}
+  BoardWithCell(const PackedBoard &bd, int cell) : board(bd), off_limit_cell(cell) {}
 };
 
 struct BoardScore {
@@ -18,16 +22,25 @@ struct BoardScore {
   BoardScore(unsigned int s, const BoardWithCell &b) : score(s), board(b) {}
 };
 
-// Scoreboard list constants for streamlined binary insertion sort
-// implementation.  Note that "BOARDS_PER_ROUND" needs to be a multiple of
-// "NUMBER_OF_WORKER_THREADS", and should be the closest multiple less than
-// "EVALUATE_LIST_SIZE".
+static_assert(std::is_trivially_copyable_v<BoardScore>);
+
+// Default sizes of the lists, which DeepSearch can change at runtime.  The evaluate
+// list should be a little longer than BOARDS_PER_ROUND.
 #define EVALUATE_LIST_SIZE 66
 #define MASTER_LIST_SIZE 1026
 
 // TODO: change these to TopN classes
-// Returns whether the item was inserted into the list.
-bool InsertIntoMasterList(std::vector<BoardScore> &list, const BoardScore &board);
-bool InsertIntoEvaluateList(std::vector<BoardScore> &list, const BoardScore &board);
+// Returns whether the item was inserted into the list, which holds at most "max_size"
+// boards.
+bool InsertIntoMasterList(
+    std::vector<BoardScore> &list,
+    const BoardScore &board,
+    unsigned int max_size = MASTER_LIST_SIZE
+);
+bool InsertIntoEvaluateList(
+    std::vector<BoardScore> &list,
+    const BoardScore &board,
+    unsigned int max_size = EVALUATE_LIST_SIZE
+);
 
 #endif  // INSERT_H
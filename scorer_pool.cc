@@ -0,0 +1,379 @@
+#include "scorer_pool.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "boggler.h"
+
+using namespace std;
+
+// A partial path: the trie node its letters lead to and the cells it uses.
+struct PathEnd {
+  Trie* node;
+  uint32_t used;
+};
+
+// The words found by carrying paths on through one changed cell of a two-cell move,
+// for one letter in that cell.  "plain" are the words of paths that don't reach the
+// other changed cell.  "open" are the words of paths that do, sorted by the letter the
+// path takes in that cell: the ones for letter b run from open_begin[b] to
+// open_begin[b + 1].  Neither holds words the move keeps from the board, and the
+// points are for each list's distinct words.
+struct MoveWords {
+  vector<uint32_t> plain;
+  uint32_t plain_points;
+  vector<pair<uint32_t, uint32_t>> open;  // (letter, word id)
+  uint32_t open_begin[kNumLetters + 1];
+  uint32_t open_points[kNumLetters];
+};
+
+// What one search of a board found, and the scratch space for scoring its moves.  It
+// holds nodes of one thread's Trie, so only that thread can use it.
+struct FoundWords {
+  FoundWords(Trie* trie, const uint8_t* points, size_t num_words)
+      : root(trie),
+        word_points(points),
+        survivor_stamps(num_words, 0),
+        seen_stamps(num_words, 0),
+        survivor_stamp(0),
+        seen_stamp(0) {}
+
+  struct Word {
+    uint32_t id;
+    uint32_t first_mask;
+    uint32_t num_masks;
+  };
+
+  Trie* const root;
+  const uint8_t* const word_points;
+  int board[kBoardCells];  // letter indices
+  vector<int> letters;     // the alphabet's letter indices
+  vector<Word> words;
+  // The distinct sets of cells each word's paths use, as bit masks.
+  vector<uint32_t> masks;
+  // (word id, cells) for every path the search finds.
+  vector<pair<uint32_t, uint32_t>> paths;
+  // frontier[c][l] holds the partial paths that end next to cell c without using it,
+  // and can be carried on if c holds letter l.  The empty path is there too.
+  vector<PathEnd> frontier[kBoardCells][kNumLetters];
+
+  // The cell a move's search leaves open, and the letters it tries there.
+  int open_cell;
+  vector<int> open_letters;
+  MoveWords moves[2][kNumLetters];
+  // Word ids are marked with the current stamp: the words a move keeps, and the words
+  // already counted for a move.
+  vector<uint32_t> survivor_stamps;
+  vector<uint32_t> seen_stamps;
+  uint32_t survivor_stamp;
+  uint32_t seen_stamp;
+};
+
+namespace {
+
+const auto& kNeighbors = BoardClassBoggler<5, 5>::NEIGHBORS;
+
+// Finds every path on f->board on from cell i, whose letter has led to "t."
+void FindPaths(FoundWords* f, int i, Trie* t, uint32_t used) {
+  used |= 1u << i;
+  if (t->IsWord()) {
+    f->paths.push_back({t->WordId(), used});
+  }
+  const int* neighbors = kNeighbors[i];
+  for (int j = 1; j <= neighbors[0]; j++) {
+    int next = neighbors[j];
+    if (used & (1u << next)) {
+      continue;
+    }
+    for (int letter : f->letters) {
+      if (letter != f->board[next] && t->StartsWord(letter)) {
+        f->frontier[next][letter].push_back({t, used});
+      }
+    }
+    int c = f->board[next];
+    if (t->StartsWord(c)) {
+      FindPaths(f, next, t->Descend(c), used);
+    }
+  }
+}
+
+// Carries a path on from cell i, whose letter has led to "t," on a board whose open
+// cell may hold any of f->open_letters.  "open_letter" is the letter the path took in
+// the open cell, or -1 if it hasn't been there.
+void FindMovePaths(
+    FoundWords* f, MoveWords* words, int i, Trie* t, uint32_t used, int open_letter
+) {
+  used |= 1u << i;
+  if (t->IsWord() && f->survivor_stamps[t->WordId()] != f->survivor_stamp) {
+    if (open_letter < 0) {
+      words->plain.push_back(t->WordId());
+    } else {
+      words->open.push_back({(uint32_t)open_letter, t->WordId()});
+    }
+  }
+  const int* neighbors = kNeighbors[i];
+  for (int j = 1; j <= neighbors[0]; j++) {
+    int next = neighbors[j];
+    if (used & (1u << next)) {
+      continue;
+    }
+    if (next == f->open_cell) {
+      for (int letter : f->open_letters) {
+        if (t->StartsWord(letter)) {
+          FindMovePaths(f, words, next, t->Descend(letter), used, letter);
+        }
+      }
+    } else if (t->StartsWord(f->board[next])) {
+      FindMovePaths(f, words, next, t->Descend(f->board[next]), used, open_letter);
+    }
+  }
+}
+
+// Fills "words" with the words of the paths that first reach a changed cell at
+// "cell," holding "letter," and don't use the cell "avoid."
+void FindMoveWords(FoundWords* f, int cell, int letter, int avoid, MoveWords* words) {
+  words->plain.clear();
+  words->open.clear();
+  int original = f->board[cell];
+  f->board[cell] = letter;
+  for (const auto& end : f->frontier[cell][letter]) {
+    if (!(end.used & (1u << avoid))) {
+      FindMovePaths(f, words, cell, end.node->Descend(letter), end.used, -1);
+    }
+  }
+  f->board[cell] = original;
+
+  sort(words->plain.begin(), words->plain.end());
+  auto plain_end = unique(words->plain.begin(), words->plain.end());
+  words->plain.erase(plain_end, words->plain.end());
+  words->plain_points = 0;
+  for (uint32_t id : words->plain) {
+    words->plain_points += f->word_points[id];
+  }
+  sort(words->open.begin(), words->open.end());
+  words->open.erase(unique(words->open.begin(), words->open.end()), words->open.end());
+  size_t k = 0;
+  for (int l = 0; l < kNumLetters; l++) {
+    words->open_begin[l] = k;
+    words->open_points[l] = 0;
+    for (; k < words->open.size() && words->open[k].first == (uint32_t)l; k++) {
+      words->open_points[l] += f->word_points[words->open[k].second];
+    }
+  }
+  words->open_begin[kNumLetters] = k;
+}
+
+}  // namespace
+
+unique_ptr<ScorerPool> ScorerPool::Create(
+    const char* dictionary, const string& alphabet, uint32_t num_threads
+) {
+  FILE* f = fopen(dictionary, "r");
+  if (!f) {
+    return NULL;
+  }
+  vector<string> words;
+  char line[80];
+  while (fscanf(f, "%79s", line) == 1) {
+    if (!Trie::BogglifyWord(line)) {
+      continue;
+    }
+    bool in_character_set = true;
+    for (char* c = line; *c && in_character_set; c++) {
+      in_character_set = alphabet.find(toupper(*c)) != string::npos;
+    }
+    if (in_character_set) {
+      words.push_back(line);
+    }
+  }
+  fclose(f);
+
+  unique_ptr<ScorerPool> pool(new ScorerPool);
+  // FNV-1a over the words, each followed by a newline.
+  pool->dictionary_hash_ = 0xcbf29ce484222325ull;
+  for (const auto& word : words) {
+    for (char c : word + '\n') {
+      pool->dictionary_hash_ = (pool->dictionary_hash_ ^ (uint8_t)c) * 0x100000001b3ull;
+    }
+  }
+  // A "q" stands for "qu," which counts as two letters.
+  for (const auto& word : words) {
+    size_t length = word.size() + count(word.begin(), word.end(), 'q');
+    pool->word_points_.push_back(kWordScores[min(length, (size_t)MAX_CELLS)]);
+  }
+  for (uint32_t i = 0; i < num_threads; i++) {
+    pool->tries_.push_back(Trie::CreateFromWordlist(words));
+    pool->bogglers_.emplace_back(new Boggler<5, 5>(pool->tries_.back().get()));
+    pool->found_.emplace_back(new FoundWords(
+        pool->tries_.back().get(), pool->word_points_.data(), words.size()
+    ));
+  }
+  return pool;
+}
+
+ScorerPool::ScorerPool() : dictionary_hash_(0) {}
+ScorerPool::~ScorerPool() {}
+
+int ScorerPool::Score(const PackedBoard& board) {
+  char letters[kBoardCells + 1];
+  UnpackBoard(board, letters);
+  return Score(0, letters);
+}
+
+int ScorerPool::Score(uint32_t thread, const char* board) {
+  return bogglers_[thread]->Score(board);
+}
+
+void ScorerPool::ForEach(size_t count, const function<void(uint32_t, size_t)>& task) {
+  atomic<size_t> next(0);
+  auto worker = [&](uint32_t thread) {
+    for (size_t i = next++; i < count; i = next++) {
+      task(thread, i);
+    }
+  };
+  vector<thread> threads;
+  for (uint32_t i = 1; i < bogglers_.size(); i++) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+void ScorerPool::ScoreTwoCellMoves(
+    uint32_t thread,
+    const BoardWithCell& board,
+    const string& alphabet,
+    TwoCellMoves kinds,
+    uint32_t min_score,
+    vector<BoardScore>* moves,
+    uint64_t* pruned
+) {
+  if (kinds == kNoTwoCellMoves) {
+    return;
+  }
+  FoundWords* f = found_[thread].get();
+  f->letters.clear();
+  for (char letter : alphabet) {
+    f->letters.push_back(letter - 'A');
+  }
+  for (int i = 0; i < kBoardCells; i++) {
+    f->board[i] = board.board.Letter(i) - 'A';
+  }
+
+  // Search the board for its paths, and group them by word.
+  f->paths.clear();
+  for (int i = 0; i < kBoardCells; i++) {
+    for (int letter : f->letters) {
+      f->frontier[i][letter].clear();
+      if (letter != f->board[i] && f->root->StartsWord(letter)) {
+        f->frontier[i][letter].push_back({f->root, 0});
+      }
+    }
+  }
+  for (int i = 0; i < kBoardCells; i++) {
+    if (f->root->StartsWord(f->board[i])) {
+      FindPaths(f, i, f->root->Descend(f->board[i]), 0);
+    }
+  }
+  sort(f->paths.begin(), f->paths.end());
+  f->paths.erase(unique(f->paths.begin(), f->paths.end()), f->paths.end());
+  f->words.clear();
+  f->masks.clear();
+  for (const auto& [id, used] : f->paths) {
+    if (f->words.empty() || f->words.back().id != id) {
+      f->words.push_back({id, (uint32_t)f->masks.size(), 0});
+    }
+    f->masks.push_back(used);
+    f->words.back().num_masks++;
+  }
+
+  vector<int> letters[2];
+  for (int c1 = 0; c1 < kBoardCells; c1++) {
+    for (int c2 = c1 + 1; c2 < kBoardCells; c2++) {
+      int cells[2] = {c1, c2};
+      if (c1 == board.off_limit_cell || c2 == board.off_limit_cell ||
+          (kinds == kSwaps && f->board[c1] == f->board[c2])) {
+        continue;
+      }
+      for (int side = 0; side < 2; side++) {
+        letters[side].clear();
+        int cell = cells[side];
+        int other = cells[1 - side];
+        if (kinds == kSwaps) {
+          letters[side].push_back(f->board[other]);
+        } else {
+          for (int letter : f->letters) {
+            if (letter != f->board[cell]) {
+              letters[side].push_back(letter);
+            }
+          }
+        }
+      }
+
+      // The words kept from the board are the ones with a path that avoids both cells.
+      uint32_t both = 1u << c1 | 1u << c2;
+      uint32_t kept_points = 0;
+      f->survivor_stamp++;
+      for (const auto& word : f->words) {
+        const uint32_t* masks = &f->masks[word.first_mask];
+        auto avoids_both = [&](uint32_t m) { return !(m & both); };
+        if (any_of(masks, masks + word.num_masks, avoids_both)) {
+          f->survivor_stamps[word.id] = f->survivor_stamp;
+          kept_points += word_points_[word.id];
+        }
+      }
+
+      for (int side = 0; side < 2; side++) {
+        f->open_cell = cells[1 - side];
+        f->open_letters = letters[1 - side];
+        for (int letter : letters[side]) {
+          MoveWords* words = &f->moves[side][letter];
+          FindMoveWords(f, cells[side], letter, cells[1 - side], words);
+        }
+      }
+
+      for (int a : letters[0]) {
+        const MoveWords& first = f->moves[0][a];
+        for (int b : letters[1]) {
+          if (kinds == kSwaps && (a != f->board[c2] || b != f->board[c1])) {
+            continue;
+          }
+          const MoveWords& second = f->moves[1][b];
+          uint32_t bound = kept_points + first.plain_points + second.plain_points +
+                           first.open_points[b] + second.open_points[a];
+          if (bound < min_score) {
+            (*pruned)++;
+            continue;
+          }
+          uint32_t score = kept_points;
+          f->seen_stamp++;
+          auto count = [&](uint32_t id) {
+            if (f->seen_stamps[id] != f->seen_stamp) {
+              f->seen_stamps[id] = f->seen_stamp;
+              score += word_points_[id];
+            }
+          };
+          for_each(first.plain.begin(), first.plain.end(), count);
+          for_each(second.plain.begin(), second.plain.end(), count);
+          for (uint32_t k = first.open_begin[b]; k < first.open_begin[b + 1]; k++) {
+            count(first.open[k].second);
+          }
+          for (uint32_t k = second.open_begin[a]; k < second.open_begin[a + 1]; k++) {
+            count(second.open[k].second);
+          }
+          BoardWithCell move(board.board, c1);
+          move.board.SetLetter(c1, 'A' + a);
+          move.board.SetLetter(c2, 'A' + b);
+          moves->push_back(BoardScore(score, move));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,94 @@
+// Scores 5x5 boards on a pool of threads, for DeepSearch and its search strategies.
+//
+// A Boggler marks the words it finds in its Trie, so every thread has its own Trie and
+// Boggler.  The Tries only hold the words spelled with the search's alphabet, since no
+// other word can appear on a board the search makes; this gives the same scores as the
+// full lexicon in a fraction of the memory.
+//
+// The pool also scores moves that change two cells, swaps and double deviations,
+// without searching each new board from scratch.  One search of the board a move
+// starts from records its words, the cells each path to them uses, and every partial
+// path that ends next to each cell.  The words a move keeps are the ones with a path
+// that avoids both changed cells.  Any other word the new board has must run through a
+// changed cell, so it's found by carrying on from the partial paths that reach one.
+// With the second changed cell left open, one such search covers every letter that
+// cell could take.  The same searches bound each move's score from above, so a move
+// that can't make a list is dropped before it's scored.
+//
+// boggler.h defines its tables outside of any template, so only scorer_pool.cc includes
+// it; everything else scores through the pool.
+#ifndef SCORER_POOL_H
+#define SCORER_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board_set.h"
+#include "insert.h"
+#include "trie.h"
+
+template <int M, int N>
+class Boggler;
+struct FoundWords;
+
+// The two-cell moves ScoreTwoCellMoves makes.  Every swap is also a double deviation.
+enum TwoCellMoves {
+  kNoTwoCellMoves,
+  kSwaps,
+  kDoubleDeviations,
+};
+
+class ScorerPool {
+ public:
+  // Returns NULL if the dictionary can't be read.
+  static std::unique_ptr<ScorerPool> Create(
+      const char* dictionary, const std::string& alphabet, uint32_t num_threads
+  );
+  ~ScorerPool();
+
+  uint32_t NumThreads() const { return bogglers_.size(); }
+  // The words the pool scores with, which are the dictionary's words over the
+  // alphabet, and a hash of them.  Two pools with the same ones give the same scores.
+  uint32_t NumWords() const { return word_points_.size(); }
+  uint64_t DictionaryHash() const { return dictionary_hash_; }
+  // Scores one board on the calling thread.
+  int Score(const PackedBoard& board);
+  // Scores a board with thread "thread"'s scorer.  Only that thread may use it.
+  int Score(uint32_t thread, const char* board);
+  // Calls task(thread, i) for every i below "count," spread over the pool's threads.
+  // The calling thread does its share of the work as thread 0.
+  void ForEach(size_t count, const std::function<void(uint32_t, size_t)>& task);
+
+  // Scores the two-cell moves of "board" that don't touch its off-limit cell, on
+  // thread "thread": swaps of two cells' letters, or double deviations, which change
+  // two cells to any other letters of "alphabet."  Moves whose upper bound is below
+  // "min_score" are counted in "pruned" and not scored.  The rest are appended to
+  // "moves" in a fixed order, with the first changed cell as their off-limit cell.
+  void ScoreTwoCellMoves(
+      uint32_t thread,
+      const BoardWithCell& board,
+      const std::string& alphabet,
+      TwoCellMoves kinds,
+      uint32_t min_score,
+      std::vector<BoardScore>* moves,
+      uint64_t* pruned
+  );
+
+ private:
+  ScorerPool();
+
+  std::vector<std::unique_ptr<Trie>> tries_;
+  std::vector<std::unique_ptr<Boggler<5, 5>>> bogglers_;
+  // Each thread's search state for ScoreTwoCellMoves.
+  std::vector<std::unique_ptr<FoundWords>> found_;
+  // Points by word id.
+  std::vector<uint8_t> word_points_;
+  uint64_t dictionary_hash_;
+};
+
+#endif  // SCORER_POOL_H
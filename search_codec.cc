@@ -0,0 +1,140 @@
+#include "search_codec.h"
+
+using namespace std;
+
+unsigned __int128 BoardToInteger(const PackedBoard& board) {
+  return (unsigned __int128)board.hi << 64 | board.lo;
+}
+
+PackedBoard IntegerToBoard(unsigned __int128 value) {
+  return PackedBoard{(uint64_t)value, (uint64_t)(value >> 64)};
+}
+
+void SearchEncoder::Varint(unsigned __int128 value) {
+  while (value >= 0x80) {
+    bytes.push_back((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  bytes.push_back(value);
+}
+
+void SearchEncoder::String(const string& s) {
+  Varint(s.size());
+  bytes.insert(bytes.end(), s.begin(), s.end());
+}
+
+// Off-limit cells run from -1, so they're stored one higher.
+void SearchEncoder::Score(const BoardScore& score) {
+  Varint(score.score);
+  Varint(score.board.off_limit_cell + 1);
+  Board(score.board.board);
+}
+
+void SearchEncoder::Scores(const vector<BoardScore>& scores) {
+  Varint(scores.size());
+  for (const auto& score : scores) {
+    Score(score);
+  }
+}
+
+void SearchEncoder::Integers(const vector<uint32_t>& integers) {
+  Varint(integers.size());
+  for (uint32_t i : integers) {
+    Varint(i);
+  }
+}
+
+void SearchEncoder::Parameters(const SearchParameters& parameters) {
+  Varint(parameters.rounds);
+  Varint(parameters.boards_per_round);
+  Varint(parameters.evaluate_list_size);
+  Varint(parameters.master_list_size);
+  Varint(parameters.canonical);
+  String(parameters.character_set);
+  Varint(parameters.dictionary_words);
+  Varint(parameters.dictionary_hash);
+}
+
+// The round is stored one higher, like the off-limit cell.
+void SearchEncoder::Progress(const SeedProgress& progress) {
+  Varint(progress.seed_number);
+  Score(progress.seed);
+  Varint(progress.round + 1);
+  Scores(progress.evaluate_list);
+}
+
+unsigned __int128 SearchDecoder::Varint() {
+  unsigned __int128 value = 0;
+  for (int shift = 0; ok_ && shift < 128; shift += 7) {
+    if (pos_ >= size_) {
+      break;
+    }
+    uint8_t byte = bytes_[pos_++];
+    value |= (unsigned __int128)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  ok_ = false;
+  return 0;
+}
+
+size_t SearchDecoder::Count() {
+  unsigned __int128 count = Varint();
+  if (count > size_ - pos_) {
+    ok_ = false;
+    return 0;
+  }
+  return count;
+}
+
+string SearchDecoder::String() {
+  size_t size = Count();
+  string s((const char*)bytes_ + pos_, size);
+  pos_ += size;
+  return s;
+}
+
+BoardScore SearchDecoder::Score() {
+  unsigned int score = Varint();
+  int off_limit_cell = (int)Varint() - 1;
+  return BoardScore(score, {Board(), off_limit_cell});
+}
+
+vector<BoardScore> SearchDecoder::Scores() {
+  vector<BoardScore> scores;
+  size_t count = Count();
+  for (size_t i = 0; i < count && ok_; i++) {
+    scores.push_back(Score());
+  }
+  return scores;
+}
+
+vector<uint32_t> SearchDecoder::Integers() {
+  size_t count = Count();
+  vector<uint32_t> integers(count);
+  for (size_t i = 0; i < count && ok_; i++) {
+    integers[i] = Varint();
+  }
+  return integers;
+}
+
+SearchParameters SearchDecoder::Parameters() {
+  SearchParameters parameters;
+  parameters.rounds = Varint();
+  parameters.boards_per_round = Varint();
+  parameters.evaluate_list_size = Varint();
+  parameters.master_list_size = Varint();
+  parameters.canonical = Varint();
+  parameters.character_set = String();
+  parameters.dictionary_words = Varint();
+  parameters.dictionary_hash = Varint();
+  return parameters;
+}
+
+SeedProgress SearchDecoder::Progress() {
+  int seed_number = Varint();
+  BoardScore seed = Score();
+  int round = (int)Varint() - 1;
+  return SeedProgress{seed_number, seed, round, Scores()};
+}
@@ -0,0 +1,64 @@
+// Varint encoding of DeepSearch's state, shared by checkpoints (checkpoint.h) and the
+// messages between a coordinator and its workers (search_protocol.h).
+//
+// Integers are little-endian base-128 varints, and boards are PackedBoards written as
+// one 128-bit varint.  A SearchDecoder never reads past its bytes: once anything is
+// missing or malformed, Ok() is false and every read after that returns zeros.
+#ifndef SEARCH_CODEC_H
+#define SEARCH_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "board_set.h"
+#include "checkpoint.h"
+#include "insert.h"
+
+unsigned __int128 BoardToInteger(const PackedBoard& board);
+PackedBoard IntegerToBoard(unsigned __int128 value);
+
+class SearchEncoder {
+ public:
+  void Varint(unsigned __int128 value);
+  void String(const std::string& s);
+  void Board(const PackedBoard& board) { Varint(BoardToInteger(board)); }
+  void Score(const BoardScore& score);
+  void Scores(const std::vector<BoardScore>& scores);
+  void Integers(const std::vector<uint32_t>& integers);
+  void Parameters(const SearchParameters& parameters);
+  void Progress(const SeedProgress& progress);
+
+  std::vector<uint8_t> bytes;
+};
+
+class SearchDecoder {
+ public:
+  SearchDecoder(const uint8_t* bytes, size_t size)
+      : pos_(0), bytes_(bytes), size_(size), ok_(true) {}
+
+  bool Ok() const { return ok_; }
+  bool AtEnd() const { return pos_ == size_; }
+
+  unsigned __int128 Varint();
+  // Reads the length of a list whose items each take at least one byte, so that a
+  // corrupt length can't make the reader allocate more than its input.
+  size_t Count();
+  std::string String();
+  PackedBoard Board() { return IntegerToBoard(Varint()); }
+  BoardScore Score();
+  std::vector<BoardScore> Scores();
+  std::vector<uint32_t> Integers();
+  SearchParameters Parameters();
+  SeedProgress Progress();
+
+ private:
+  size_t pos_;
+  const uint8_t* bytes_;
+  size_t size_;
+  bool ok_;
+};
+
+#endif  // SEARCH_CODEC_H
@@ -0,0 +1,122 @@
+#include "search_protocol.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+bool WriteAll(int fd, const uint8_t* bytes, size_t size) {
+  while (size > 0) {
+    // MSG_NOSIGNAL turns a worker that has gone away into an error, not a SIGPIPE.
+    ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool ReadAll(int fd, uint8_t* bytes, size_t size) {
+  while (size > 0) {
+    ssize_t n = read(fd, bytes, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool MakeAddress(const string& path, sockaddr_un* address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address->sun_path)) {
+    fprintf(stderr, "Socket path %s is too long\n", path.c_str());
+    return false;
+  }
+  memcpy(address->sun_path, path.c_str(), path.size());
+  return true;
+}
+
+}  // namespace
+
+bool SendSearchMessage(
+    int fd, SearchMessageType type, const vector<uint8_t>& payload
+) {
+  uint32_t size = payload.size();
+  uint8_t header[5] = {type};
+  for (int i = 0; i < 4; i++) {
+    header[1 + i] = size >> (8 * i);
+  }
+  return WriteAll(fd, header, sizeof(header)) &&
+         WriteAll(fd, payload.data(), payload.size());
+}
+
+bool ReceiveSearchMessage(int fd, SearchMessageType* type, vector<uint8_t>* payload) {
+  uint8_t header[5];
+  if (!ReadAll(fd, header, sizeof(header))) {
+    return false;
+  }
+  uint32_t size = 0;
+  for (int i = 0; i < 4; i++) {
+    size |= (uint32_t)header[1 + i] << (8 * i);
+  }
+  if (size > kMaxSearchMessageBytes) {
+    return false;
+  }
+  *type = (SearchMessageType)header[0];
+  payload->resize(size);
+  return ReadAll(fd, payload->data(), size);
+}
+
+int ListenOnUnixSocket(const string& path) {
+  sockaddr_un address;
+  if (!MakeAddress(path, &address)) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("socket");
+    return -1;
+  }
+  unlink(path.c_str());
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+    fprintf(stderr, "Couldn't listen on %s: %s\n", path.c_str(), strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int ConnectToUnixSocket(const string& path) {
+  sockaddr_un address;
+  if (!MakeAddress(path, &address)) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("socket");
+    return -1;
+  }
+  if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    fprintf(stderr, "Couldn't connect to %s: %s\n", path.c_str(), strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
@@ -0,0 +1,67 @@
+// Messages between a DeepSearch coordinator and its workers.
+//
+// The coordinator keeps the search state: the master list, the evaluated boards, the
+// seeds and any checkpoints.  Workers connect to it over a Unix domain socket, are sent
+// the search parameters, reply with the dictionary they loaded, and then ask for seeds
+// one at a time.  A worker whose dictionary doesn't match the parameters' is refused,
+// since its scores would be for another word list.  A worker runs the rounds of its
+// seed and, after each one, sends the scores of the round's deviations.  The
+// coordinator knows which boards the round deviated, since it handed out the evaluate
+// list they came from, so the scores alone say which board each deviation is.  It adds
+// them to the master list, marks the deviated boards as evaluated and replies with the
+// seed's next evaluate list.
+//
+// Each message is a type byte, a 32-bit little-endian payload length and a payload
+// written with SearchEncoder.
+//
+//   worker                        coordinator
+//                                 kParameters {SearchParameters}
+//   kDictionary {words, hash}
+//   kSeedRequest {}
+//                                 kSeed {SeedProgress} or kNoMoreSeeds {}
+//   kRoundDone {seed, round, deviation scores}
+//                                 kEvaluateList {evaluate list}
+//   ...
+//   kSeedDone {seed}
+//   kSeedRequest {}
+//   ...
+//
+// A seed handed out as kSeed may already be part way done, if it was taken from a
+// worker that disconnected.  Its SeedProgress says which round to start from.
+#ifndef SEARCH_PROTOCOL_H
+#define SEARCH_PROTOCOL_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+enum SearchMessageType : uint8_t {
+  kParameters = 1,
+  kSeedRequest,
+  kSeed,
+  kNoMoreSeeds,
+  kRoundDone,
+  kEvaluateList,
+  kSeedDone,
+  kDictionary,
+};
+
+// No message comes anywhere near this; a longer length means the stream is corrupt.
+const uint32_t kMaxSearchMessageBytes = 1 << 28;
+
+// These return false if the connection is closed or broken.
+bool SendSearchMessage(
+    int fd, SearchMessageType type, const std::vector<uint8_t>& payload
+);
+bool ReceiveSearchMessage(
+    int fd, SearchMessageType* type, std::vector<uint8_t>* payload
+);
+
+// Returns a socket listening at "path," replacing any socket file already there, or -1
+// on failure.
+int ListenOnUnixSocket(const std::string& path);
+// Returns a socket connected to "path," or -1 on failure.
+int ConnectToUnixSocket(const std::string& path);
+
+#endif  // SEARCH_PROTOCOL_H
@@ -0,0 +1,382 @@
+#include "search_strategy.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+SearchBackend::SearchBackend(
+    ScorerPool* scorers,
+    const SearchParameters& parameters,
+    const SearchBudget& budget
+)
+    : scorers_(scorers),
+      parameters_(parameters),
+      budget_(budget),
+      start_(chrono::steady_clock::now()),
+      evaluations_(0),
+      cache_hits_(0),
+      pruned_(0) {
+  best_.reserve(parameters.master_list_size);
+}
+
+size_t SearchBackend::Score(
+    const vector<BoardWithCell>& boards, vector<BoardScore>* scores
+) {
+  scores->assign(boards.size(), BoardScore(0, {PackedBoard{0, 0}, -1}));
+  if (budget_.max_seconds > 0 && Seconds() >= budget_.max_seconds) {
+    return 0;
+  }
+  uint64_t remaining = UINT64_MAX;
+  if (budget_.max_evaluations > 0) {
+    remaining = budget_.max_evaluations - min(evaluations_, budget_.max_evaluations);
+  }
+
+  // Take what's cached, and list the rest to be scored until the budget runs out.  A
+  // board that comes up twice in one batch is only scored once: "pending" maps it to
+  // its place in "to_score."
+  vector<size_t> to_score;
+  vector<size_t> repeats;
+  BoardScoreMap pending;
+  size_t n = 0;
+  for (; n < boards.size(); n++) {
+    PackedBoard key = CanonicalBoard(boards[n].board);
+    uint32_t score;
+    if (cache_.Find(key, &score)) {
+      (*scores)[n] = BoardScore(score, boards[n]);
+      cache_hits_++;
+    } else if (pending.Find(key, &score)) {
+      repeats.push_back(n);
+      cache_hits_++;
+    } else if (to_score.size() < remaining) {
+      pending.Insert(key, to_score.size());
+      to_score.push_back(n);
+    } else {
+      break;
+    }
+  }
+
+  scorers_->ForEach(to_score.size(), [&](uint32_t thread, size_t i) {
+    const auto& board = boards[to_score[i]];
+    char letters[kBoardCells + 1];
+    UnpackBoard(board.board, letters);
+    int score = scorers_->Score(thread, letters);
+    (*scores)[to_score[i]] = BoardScore(score, board);
+  });
+  for (size_t i : to_score) {
+    cache_.Insert(CanonicalBoard(boards[i].board), (*scores)[i].score);
+  }
+  for (size_t i : repeats) {
+    uint32_t score;
+    cache_.Find(CanonicalBoard(boards[i].board), &score);
+    (*scores)[i] = BoardScore(score, boards[i]);
+  }
+  evaluations_ += to_score.size();
+
+  // As with DeepSearch's master list, nothing at or below the lowest score on a full
+  // list can get on.
+  bool full = best_.size() == parameters_.master_list_size;
+  unsigned int min_score = full ? best_.back().score : 0;
+  for (size_t i = 0; i < n; i++) {
+    if (!full || (*scores)[i].score > min_score) {
+      InsertIntoMasterList(best_, (*scores)[i], parameters_.master_list_size);
+    }
+  }
+  return n;
+}
+
+bool SearchBackend::ScoreTwoCellMoves(
+    const vector<BoardWithCell>& sources,
+    TwoCellMoves kinds,
+    uint32_t min_score,
+    vector<BoardScore>* scores
+) {
+  scores->clear();
+  if (budget_.max_seconds > 0 && Seconds() >= budget_.max_seconds) {
+    return false;
+  }
+  uint64_t remaining = UINT64_MAX;
+  if (budget_.max_evaluations > 0) {
+    remaining = budget_.max_evaluations - min(evaluations_, budget_.max_evaluations);
+  }
+
+  vector<vector<BoardScore>> moves(sources.size());
+  vector<uint64_t> pruned(sources.size(), 0);
+  scorers_->ForEach(sources.size(), [&](uint32_t thread, size_t i) {
+    scorers_->ScoreTwoCellMoves(
+        thread,
+        sources[i],
+        parameters_.character_set,
+        kinds,
+        min_score,
+        &moves[i],
+        &pruned[i]
+    );
+  });
+
+  // Moves already in the cache are free, as in Score.
+  for (size_t i = 0; i < sources.size(); i++) {
+    pruned_ += pruned[i];
+    for (const auto& move : moves[i]) {
+      PackedBoard key = CanonicalBoard(move.board.board);
+      uint32_t score;
+      if (cache_.Find(key, &score)) {
+        cache_hits_++;
+      } else if (remaining > 0) {
+        cache_.Insert(key, move.score);
+        evaluations_++;
+        remaining--;
+      } else {
+        return false;
+      }
+      scores->push_back(move);
+      if (best_.size() < parameters_.master_list_size ||
+          move.score > best_.back().score) {
+        InsertIntoMasterList(best_, move, parameters_.master_list_size);
+      }
+    }
+  }
+  return true;
+}
+
+bool SearchBackend::Exhausted() const {
+  return (budget_.max_evaluations > 0 && evaluations_ >= budget_.max_evaluations) ||
+         (budget_.max_seconds > 0 && Seconds() >= budget_.max_seconds);
+}
+
+double SearchBackend::Progress() const {
+  double progress = 0;
+  if (budget_.max_evaluations > 0) {
+    progress = (double)evaluations_ / budget_.max_evaluations;
+  }
+  if (budget_.max_seconds > 0) {
+    progress = max(progress, Seconds() / budget_.max_seconds);
+  }
+  return min(progress, 1.0);
+}
+
+bool SearchBackend::MarkEvaluated(const PackedBoard& board) {
+  return evaluated_.Insert(Key(board));
+}
+
+bool SearchBackend::IsEvaluated(const PackedBoard& board) const {
+  return evaluated_.Contains(Key(board));
+}
+
+PackedBoard SearchBackend::Key(const PackedBoard& board) const {
+  return parameters_.canonical ? CanonicalBoard(board) : board;
+}
+
+double SearchBackend::Seconds() const {
+  return chrono::duration<double>(chrono::steady_clock::now() - start_).count();
+}
+
+vector<BoardWithCell> SingleDeviations(
+    const vector<BoardWithCell>& boards, const string& alphabet
+) {
+  vector<BoardWithCell> deviations;
+  deviations.reserve(boards.size() * kBoardCells * alphabet.size());
+  for (const auto& board : boards) {
+    for (int cell = 0; cell < kBoardCells; cell++) {
+      if (cell == board.off_limit_cell) {
+        continue;
+      }
+      BoardWithCell deviation(board.board, cell);
+      char original = board.board.Letter(cell);
+      for (char letter : alphabet) {
+        if (letter != original) {
+          deviation.board.SetLetter(cell, letter);
+          deviations.push_back(deviation);
+        }
+      }
+    }
+  }
+  return deviations;
+}
+
+namespace {
+
+// Adds the two-cell moves of "sources" that haven't been expanded to "list," which
+// holds at most "max_size" boards.  Returns false if the budget ran out.
+bool AddTwoCellMoves(
+    SearchBackend* backend,
+    const vector<BoardWithCell>& sources,
+    TwoCellMoves kinds,
+    vector<BoardScore>* list,
+    uint32_t max_size
+) {
+  if (kinds == kNoTwoCellMoves) {
+    return true;
+  }
+  // Nothing at or below the lowest score on a full list can get on.
+  bool full = list->size() == max_size;
+  uint32_t min_score = full ? list->back().score + 1 : 0;
+  vector<BoardScore> moves;
+  bool finished = backend->ScoreTwoCellMoves(sources, kinds, min_score, &moves);
+  for (const auto& move : moves) {
+    if (!backend->IsEvaluated(move.board.board)) {
+      InsertIntoEvaluateList(*list, move, max_size);
+    }
+  }
+  return finished;
+}
+
+}  // namespace
+
+void LocustSwarmStrategy::Run(const PackedBoard& seed_board, SearchBackend* backend) {
+  const SearchParameters& parameters = backend->Parameters();
+  vector<BoardScore> scores;
+  backend->Score({{seed_board, 0}}, &scores);
+
+  BoardSet chosen_seeds;
+  for (int s = 0; s < num_seeds_ && !backend->Exhausted(); s++) {
+    // The best board that hasn't been a seed.
+    PackedBoard seed{0, 0};
+    for (const auto& result : backend->Best()) {
+      if (chosen_seeds.Insert(backend->Key(result.board.board))) {
+        seed = result.board.board;
+        break;
+      }
+    }
+    if (seed.IsEmpty()) {
+      return;
+    }
+
+    vector<BoardScore> evaluate_list;
+    for (int round = -1; round < (int)parameters.rounds; round++) {
+      vector<BoardWithCell> sources;
+      if (round < 0) {
+        sources.push_back({seed, -1});
+      } else {
+        for (size_t i = 0; i < evaluate_list.size() && i < parameters.boards_per_round;
+             i++) {
+          sources.push_back(evaluate_list[i].board);
+        }
+      }
+      auto deviations = SingleDeviations(sources, parameters.character_set);
+      size_t scored = backend->Score(deviations, &scores);
+      if (round >= 0) {
+        for (const auto& source : sources) {
+          backend->MarkEvaluated(source.board);
+        }
+      }
+      evaluate_list.clear();
+      for (size_t i = 0; i < scored; i++) {
+        if (!backend->IsEvaluated(scores[i].board.board)) {
+          InsertIntoEvaluateList(
+              evaluate_list, scores[i], parameters.evaluate_list_size
+          );
+        }
+      }
+      if (scored < deviations.size() ||
+          !AddTwoCellMoves(
+              backend,
+              sources,
+              two_cell_moves_,
+              &evaluate_list,
+              parameters.evaluate_list_size
+          )) {
+        return;
+      }
+    }
+  }
+}
+
+void AnnealingStrategy::Run(const PackedBoard& seed_board, SearchBackend* backend) {
+  const string& alphabet = backend->Parameters().character_set;
+  if (alphabet.size() < 2) {
+    return;
+  }
+  mt19937_64 random(random_seed_);
+  uniform_real_distribution<double> uniform(0, 1);
+  vector<BoardScore> scores;
+  if (backend->Score({{seed_board, -1}}, &scores) == 0) {
+    return;
+  }
+  PackedBoard current = seed_board;
+  double current_score = scores[0].score;
+
+  const SearchBudget& budget = backend->Budget();
+  uint64_t moves_tried = 0;
+  vector<BoardWithCell> moves;
+  while (!backend->Exhausted()) {
+    double progress = backend->Progress();
+    if (budget.max_evaluations > 0) {
+      progress = max(progress, (double)moves_tried / budget.max_evaluations);
+    }
+    if (progress >= 1) {
+      return;
+    }
+    double temperature =
+        start_temperature_ * pow(end_temperature_ / start_temperature_, progress);
+    moves.clear();
+    for (uint32_t i = 0; i < moves_per_step_; i++) {
+      int cell = random() % kBoardCells;
+      // Any letter but the one already there.
+      size_t letter = random() % (alphabet.size() - 1);
+      if (alphabet[letter] == current.Letter(cell)) {
+        letter = alphabet.size() - 1;
+      }
+      BoardWithCell move(current, cell);
+      move.board.SetLetter(cell, alphabet[letter]);
+      moves.push_back(move);
+    }
+    size_t scored = backend->Score(moves, &scores);
+    moves_tried += scored;
+    for (size_t i = 0; i < scored; i++) {
+      double delta = scores[i].score - current_score;
+      if (delta >= 0 || uniform(random) < exp(delta / temperature)) {
+        current = moves[i].board;
+        current_score = scores[i].score;
+        break;
+      }
+    }
+    if (scored < moves.size()) {
+      return;
+    }
+  }
+}
+
+void BeamSearchStrategy::Run(const PackedBoard& seed_board, SearchBackend* backend) {
+  const string& alphabet = backend->Parameters().character_set;
+  vector<BoardScore> beam;
+  if (backend->Score({{seed_board, -1}}, &beam) == 0) {
+    return;
+  }
+  vector<BoardScore> scores;
+  while (!backend->Exhausted()) {
+    vector<BoardWithCell> sources;
+    for (const auto& b : beam) {
+      if (backend->MarkEvaluated(b.board.board)) {
+        sources.push_back(b.board);
+      }
+    }
+    auto deviations = SingleDeviations(sources, alphabet);
+    size_t scored = backend->Score(deviations, &scores);
+
+    beam.clear();
+    for (size_t i = 0; i < scored; i++) {
+      if (!backend->IsEvaluated(scores[i].board.board)) {
+        InsertIntoEvaluateList(beam, scores[i], beam_width_);
+      }
+    }
+    if (scored < deviations.size() ||
+        !AddTwoCellMoves(backend, sources, two_cell_moves_, &beam, beam_width_)) {
+      return;
+    }
+    // Every deviation has been expanded already, so start again from the best boards
+    // found that haven't been.
+    if (beam.empty()) {
+      for (const auto& b : backend->Best()) {
+        if (!backend->IsEvaluated(b.board.board)) {
+          InsertIntoEvaluateList(beam, b, beam_width_);
+        }
+      }
+    }
+    if (beam.empty()) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,182 @@
+// Search strategies for DeepSearch, to be compared on the same budget of evaluations.
+//
+// Scoring boards is what a search pays for, so every strategy runs on a SearchBackend
+// that does all its scoring.  The backend scores batches of boards on a ScorerPool,
+// caches every score (keyed by canonical board, so a rotation or reflection of a board
+// already scored is free), and counts each board it actually scores as an evaluation.
+// It stops scoring once the budget of evaluations or seconds runs out.  It also keeps
+// the set of boards a strategy has expanded and the best boards seen so far.
+//
+// LocustSwarmStrategy is JPA's "Intelligent Locust Swarm," the search DeepSearch runs
+// by default, on the backend.  AnnealingStrategy is simulated annealing over single
+// letter changes, and BeamSearchStrategy keeps the best boards of each generation of
+// single deviations, restarting from the best unexpanded board when it runs dry.
+//
+// The locust swarm and beam search can also try the two-cell moves of the boards they
+// expand, swaps or double deviations, which the ScorerPool scores incrementally.  They
+// ask only for the moves that could make one of their lists, so most double deviations
+// are pruned by their upper bounds and never scored.
+#ifndef SEARCH_STRATEGY_H
+#define SEARCH_STRATEGY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board_set.h"
+#include "checkpoint.h"
+#include "insert.h"
+#include "scorer_pool.h"
+
+// Zero means no limit.
+struct SearchBudget {
+  uint64_t max_evaluations;
+  double max_seconds;
+};
+
+class SearchBackend {
+ public:
+  // The best list holds parameters.master_list_size boards, and the evaluated boards
+  // are canonical if parameters.canonical is set.
+  SearchBackend(
+      ScorerPool* scorers,
+      const SearchParameters& parameters,
+      const SearchBudget& budget
+  );
+
+  const SearchParameters& Parameters() const { return parameters_; }
+  const SearchBudget& Budget() const { return budget_; }
+  uint32_t NumThreads() const { return scorers_->NumThreads(); }
+
+  // Scores "boards" into "scores," in order, spreading the work over the pool.  Once
+  // the budget runs out the rest of the boards are left unscored, so this returns how
+  // many were scored.  Every board scored is also offered to the best list.
+  size_t Score(
+      const std::vector<BoardWithCell>& boards, std::vector<BoardScore>* scores
+  );
+  // Scores the two-cell moves of "sources" into "scores," in order, each source's
+  // moves scored on one thread.  Moves that can't reach "min_score" are pruned, and
+  // since they're never scored, they're never offered to the best list either.  Each
+  // move scored counts as an evaluation, though it costs much less than scoring a
+  // board.  Returns false if the budget ran out, in which case "scores" holds the moves
+  // taken before it did.
+  bool ScoreTwoCellMoves(
+      const std::vector<BoardWithCell>& sources,
+      TwoCellMoves kinds,
+      uint32_t min_score,
+      std::vector<BoardScore>* scores
+  );
+  bool Exhausted() const;
+  // How much of the budget has been used, from 0 to 1: the larger of the fractions
+  // of evaluations and seconds.  Always 0 without a budget.
+  double Progress() const;
+
+  // Marks "board" as expanded.  Returns false if it already was.
+  bool MarkEvaluated(const PackedBoard& board);
+  bool IsEvaluated(const PackedBoard& board) const;
+  // The key boards are stored under in the evaluated set.
+  PackedBoard Key(const PackedBoard& board) const;
+
+  // Highest score first.
+  const std::vector<BoardScore>& Best() const { return best_; }
+  uint64_t Evaluations() const { return evaluations_; }
+  uint64_t CacheHits() const { return cache_hits_; }
+  // Two-cell moves dropped on their upper bounds.
+  uint64_t Pruned() const { return pruned_; }
+  double Seconds() const;
+  size_t Bytes() const { return cache_.Bytes() + evaluated_.Bytes(); }
+
+ private:
+  ScorerPool* scorers_;
+  const SearchParameters parameters_;
+  const SearchBudget budget_;
+  const std::chrono::steady_clock::time_point start_;
+  BoardScoreMap cache_;
+  BoardSet evaluated_;
+  std::vector<BoardScore> best_;
+  uint64_t evaluations_;
+  uint64_t cache_hits_;
+  uint64_t pruned_;
+};
+
+// Every single letter change to "boards" from the alphabet, skipping each board's
+// off-limit cell.  The cell changed becomes the new board's off-limit cell.
+std::vector<BoardWithCell> SingleDeviations(
+    const std::vector<BoardWithCell>& boards, const std::string& alphabet
+);
+
+class SearchStrategy {
+ public:
+  virtual ~SearchStrategy() {}
+
+  virtual const char* Name() const = 0;
+  // Searches from "seed_board" until the strategy is done or the budget runs out.
+  virtual void Run(const PackedBoard& seed_board, SearchBackend* backend) = 0;
+};
+
+// Runs "num_seeds" seeds of the search parameters' rounds, one at a time.  Each round
+// adds the "two_cell_moves" of its boards to their single deviations.
+class LocustSwarmStrategy : public SearchStrategy {
+ public:
+  LocustSwarmStrategy(int num_seeds, TwoCellMoves two_cell_moves)
+      : num_seeds_(num_seeds), two_cell_moves_(two_cell_moves) {}
+
+  const char* Name() const override { return "locust"; }
+  void Run(const PackedBoard& seed_board, SearchBackend* backend) override;
+
+ private:
+  const int num_seeds_;
+  const TwoCellMoves two_cell_moves_;
+};
+
+// The temperature falls geometrically from "start_temperature" to "end_temperature"
+// over the budget.  To keep the pool busy, each step scores a batch of random moves
+// from the current board and takes the first one the Metropolis rule accepts, so the
+// walk is the one a sequential annealer would make, less the moves after the accepted
+// one.  Needs a budget.  Moves to boards already scored are free, so the schedule
+// counts every move against the evaluation budget; otherwise a walk that has scored
+// all its neighbors would never cool or finish.
+class AnnealingStrategy : public SearchStrategy {
+ public:
+  AnnealingStrategy(
+      double start_temperature,
+      double end_temperature,
+      uint32_t moves_per_step,
+      uint64_t random_seed
+  )
+      : start_temperature_(start_temperature),
+        end_temperature_(end_temperature),
+        moves_per_step_(moves_per_step),
+        random_seed_(random_seed) {}
+
+  const char* Name() const override { return "annealing"; }
+  void Run(const PackedBoard& seed_board, SearchBackend* backend) override;
+
+ private:
+  const double start_temperature_;
+  const double end_temperature_;
+  const uint32_t moves_per_step_;
+  const uint64_t random_seed_;
+};
+
+// Each generation scores every single deviation of the beam at once, and its
+// "two_cell_moves," and keeps the best "beam_width" that haven't been expanded.  Needs
+// a budget.
+class BeamSearchStrategy : public SearchStrategy {
+ public:
+  BeamSearchStrategy(uint32_t beam_width, TwoCellMoves two_cell_moves)
+      : beam_width_(beam_width), two_cell_moves_(two_cell_moves) {}
+
+  const char* Name() const override { return "beam"; }
+  void Run(const PackedBoard& seed_board, SearchBackend* backend) override;
+
+ private:
+  const uint32_t beam_width_;
+  const TwoCellMoves two_cell_moves_;
+};
+
+#endif  // SEARCH_STRATEGY_H
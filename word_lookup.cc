@@ -0,0 +1,210 @@
+#include "word_lookup.h"
+
+#include <ctype.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+// Sorted words are claimed by threads this many at a time.
+#define WORDS_PER_CHUNK 4096
+
+namespace {
+
+// Each lexicon supplies a Position (where a prefix leads), the position of the empty
+// prefix, a step by one upper case letter and the word id at a position.
+class AdtdawgLexicon {
+ public:
+  struct Position {
+    uint32_t node;
+    uint32_t word_index;
+  };
+
+  explicit AdtdawgLexicon(const Adtdawg& dawg) : dawg_(dawg) {
+    for (int i = 0; i < 26; i++) {
+      letter_indices_[i] = -1;
+    }
+    for (size_t i = 0; i < dawg.Alphabet().size(); i++) {
+      letter_indices_[dawg.Alphabet()[i] - 'A'] = i;
+    }
+  }
+
+  Position Root() const { return {0, 0}; }
+
+  bool Step(Position* position, char c) const {
+    int letter = letter_indices_[c - 'A'];
+    if (letter < 0) {
+      return false;
+    }
+    // The top level nodes act as the root's children.
+    if (position->node == 0) {
+      position->node = letter + 1;
+      position->word_index = dawg_.Tracking()[letter + 1];
+      return true;
+    }
+    uint32_t child = dawg_.Child(position->node, letter);
+    if (!child) {
+      return false;
+    }
+    position->word_index =
+        dawg_.ChildWordIndex(position->node, position->word_index, child);
+    position->node = child;
+    return true;
+  }
+
+  uint32_t WordId(const Position& position) const {
+    if (position.node == 0 || !dawg_.IsWord(position.node)) {
+      return kWordNotFound;
+    }
+    return position.word_index;
+  }
+
+ private:
+  const Adtdawg& dawg_;
+  int letter_indices_[26];
+};
+
+class TrieLexicon {
+ public:
+  typedef const Trie* Position;
+
+  explicit TrieLexicon(const Trie& trie) : trie_(trie) {}
+
+  Position Root() const { return &trie_; }
+
+  bool Step(Position* position, char c) const {
+    *position = (*position)->Descend(c - 'A');
+    return *position != nullptr;
+  }
+
+  uint32_t WordId(const Position& position) const {
+    return position->IsWord() ? position->WordId() : kWordNotFound;
+  }
+
+ private:
+  const Trie& trie_;
+};
+
+// Converts "word" to an upper case Boggle word, with "QU" as "Q."  Returns false if it
+// can't be one.
+bool ToBoggleWord(const string& word, string* boggle_word) {
+  boggle_word->clear();
+  for (size_t i = 0; i < word.size(); i++) {
+    char c = toupper(word[i]);
+    if (c < 'A' || c > 'Z') {
+      return false;
+    }
+    if (c == 'Q') {
+      if (i + 1 >= word.size() || toupper(word[i + 1]) != 'U') {
+        return false;
+      }
+      i++;
+    }
+    boggle_word->push_back(c);
+  }
+  return !boggle_word->empty();
+}
+
+template <typename Lexicon>
+void LookUpWorker(
+    const Lexicon& lexicon,
+    const vector<string>& keys,
+    const vector<uint32_t>& order,
+    vector<uint32_t>& ids,
+    atomic<size_t>& next_chunk
+) {
+  // path[d] is where the first d letters of the previous word lead, for d up to
+  // "depth," the number of its letters found in the lexicon.
+  vector<typename Lexicon::Position> path;
+  size_t depth = 0;
+  const string* previous = nullptr;
+  for (size_t begin = next_chunk.fetch_add(WORDS_PER_CHUNK); begin < order.size();
+       begin = next_chunk.fetch_add(WORDS_PER_CHUNK)) {
+    path.assign(1, lexicon.Root());
+    depth = 0;
+    previous = nullptr;
+    size_t end = min(order.size(), begin + WORDS_PER_CHUNK);
+    for (size_t i = begin; i < end; i++) {
+      const string& key = keys[order[i]];
+      if (key.empty()) {
+        ids[order[i]] = kWordNotFound;
+        continue;
+      }
+      // Resume from the longest prefix shared with the previous word.
+      if (previous) {
+        size_t shared = 0;
+        while (shared < depth && shared < key.size() &&
+               key[shared] == (*previous)[shared]) {
+          shared++;
+        }
+        depth = shared;
+      }
+      path.resize(depth + 1);
+      while (depth < key.size()) {
+        auto position = path[depth];
+        if (!lexicon.Step(&position, key[depth])) {
+          break;
+        }
+        path.push_back(position);
+        depth++;
+      }
+      ids[order[i]] = depth == key.size() ? lexicon.WordId(path[depth]) : kWordNotFound;
+      previous = &key;
+    }
+  }
+}
+
+template <typename Lexicon>
+vector<uint32_t> LookUpWith(
+    const Lexicon& lexicon, const vector<string>& words, uint32_t num_threads
+) {
+  // Words that can't be Boggle words get an empty key, which is never found.
+  vector<string> keys(words.size());
+  for (size_t i = 0; i < words.size(); i++) {
+    if (!ToBoggleWord(words[i], &keys[i])) {
+      keys[i].clear();
+    }
+  }
+  vector<uint32_t> order(words.size());
+  for (uint32_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) {
+    return keys[a] < keys[b];
+  });
+
+  vector<uint32_t> ids(words.size(), kWordNotFound);
+  atomic<size_t> next_chunk(0);
+  vector<thread> threads;
+  for (uint32_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(
+        LookUpWorker<Lexicon>,
+        cref(lexicon),
+        cref(keys),
+        cref(order),
+        ref(ids),
+        ref(next_chunk)
+    );
+  }
+  LookUpWorker(lexicon, keys, order, ids, next_chunk);
+  for (auto& t : threads) {
+    t.join();
+  }
+  return ids;
+}
+
+}  // namespace
+
+vector<uint32_t> LookUpWords(
+    const Adtdawg& dawg, const vector<string>& words, uint32_t num_threads
+) {
+  return LookUpWith(AdtdawgLexicon(dawg), words, num_threads);
+}
+
+vector<uint32_t> LookUpWords(
+    const Trie& trie, const vector<string>& words, uint32_t num_threads
+) {
+  return LookUpWith(TrieLexicon(trie), words, num_threads);
+}
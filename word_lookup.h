@@ -0,0 +1,33 @@
+// Looks up batches of words in a read-only lexicon, either an ADTDAWG or a Trie.
+//
+// The words are sorted first, so that each lookup only walks the part of its word
+// that differs from the one before; a batch of similar words costs little more than
+// walking the distinct prefixes once.  The sorted words are handed out to threads in
+// chunks, and each thread keeps its own path through the lexicon.
+//
+// Words are matched as Boggle words: case doesn't matter and "QU" is looked up as the
+// lexicon's "Q."  Words that can't be Boggle words are simply not found.
+#ifndef WORD_LOOKUP_H
+#define WORD_LOOKUP_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "adtdawg.h"
+#include "trie.h"
+
+// The result for a word that isn't in the lexicon.  ADTDAWG word ids run from 1 to
+// NumWords() and Trie word ids from 0, so neither uses this.
+const uint32_t kWordNotFound = 0xffffffff;
+
+// Returns the word id of each word, or kWordNotFound, in input order.
+std::vector<uint32_t> LookUpWords(
+    const Adtdawg& dawg, const std::vector<std::string>& words, uint32_t num_threads
+);
+std::vector<uint32_t> LookUpWords(
+    const Trie& trie, const std::vector<std::string>& words, uint32_t num_threads
+);
+
+#endif  // WORD_LOOKUP_H
@@ -0,0 +1,173 @@
+#include "word_table.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <bit>
+
+using namespace std;
+
+unique_ptr<WordTable> WordTable::Build(const Adtdawg& dawg) {
+  vector<string> words(dawg.NumWords() + 1);
+  string word;
+  auto walk = [&](auto& self, uint32_t node, uint32_t word_index) -> void {
+    if (dawg.IsWord(node)) {
+      words[word_index] = word;
+    }
+    uint32_t first_child = dawg.FirstChild(node);
+    if (!first_child) {
+      return;
+    }
+    for (uint32_t mask = dawg.ChildMask(node); mask; mask &= mask - 1) {
+      uint32_t child = dawg.Child(node, countr_zero(mask));
+      word.push_back(dawg.Alphabet()[countr_zero(mask)]);
+      self(self, child, dawg.ChildWordIndex(node, word_index, child));
+      word.pop_back();
+    }
+  };
+  // The top level nodes act as the root's children.
+  for (uint32_t letter = 0; letter < dawg.Alphabet().size(); letter++) {
+    word.assign(1, dawg.Alphabet()[letter]);
+    walk(walk, letter + 1, dawg.Tracking()[letter + 1]);
+  }
+
+  unique_ptr<WordTable> table(new WordTable);
+  table->num_words_ = dawg.NumWords();
+  for (uint32_t id = 1; id <= dawg.NumWords(); id++) {
+    const string& w = words[id];
+    size_t shared = 0;
+    if ((id - 1) % kWordsPerBlock == 0) {
+      table->block_offsets_.push_back(table->data_.size());
+    } else {
+      const string& previous = words[id - 1];
+      while (shared < w.size() && shared < previous.size() &&
+             w[shared] == previous[shared]) {
+        shared++;
+      }
+    }
+    if (w.size() > kMaxWordLength) {
+      fprintf(stderr, "%s is too long for a word table\n", w.c_str());
+      return NULL;
+    }
+    table->data_.push_back(shared << 4 | (w.size() - shared));
+    table->data_.insert(table->data_.end(), w.begin() + shared, w.end());
+  }
+  return table;
+}
+
+unique_ptr<WordTable> WordTable::Load(const char* filename) {
+  FILE* f = fopen(filename, "rb");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", filename);
+    return NULL;
+  }
+  unique_ptr<WordTable> table(new WordTable);
+  WordTableHeader header;
+  uint32_t num_blocks = 0;
+  bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+            memcmp(header.magic, kWordTableMagic, sizeof(kWordTableMagic)) == 0 &&
+            header.version == kWordTableVersion &&
+            header.words_per_block == kWordsPerBlock;
+  if (ok) {
+    num_blocks = (header.num_words + kWordsPerBlock - 1) / kWordsPerBlock;
+    ok = header.num_blocks == num_blocks;
+  }
+  if (ok) {
+    table->num_words_ = header.num_words;
+    table->block_offsets_.resize(header.num_blocks);
+    table->data_.resize(header.data_bytes);
+    ok = fread(table->block_offsets_.data(), sizeof(uint32_t), header.num_blocks, f) ==
+             header.num_blocks &&
+         fread(table->data_.data(), 1, header.data_bytes, f) == header.data_bytes;
+  }
+  fclose(f);
+  ok = ok && table->EntriesValid();
+  if (!ok) {
+    fprintf(stderr, "Unable to read the word table from %s\n", filename);
+    return NULL;
+  }
+  return table;
+}
+
+bool WordTable::EntriesValid() const {
+  for (uint32_t block = 0; block < block_offsets_.size(); block++) {
+    size_t pos = block_offsets_[block];
+    size_t length = 0;
+    uint32_t first_id = block * kWordsPerBlock + 1;
+    for (uint32_t id = first_id; id < first_id + kWordsPerBlock && id <= num_words_;
+         id++) {
+      if (pos >= data_.size()) {
+        return false;
+      }
+      size_t shared = data_[pos] >> 4;
+      size_t suffix = data_[pos] & 0xf;
+      if (shared > length || shared + suffix > kMaxWordLength ||
+          suffix > data_.size() - pos - 1) {
+        return false;
+      }
+      length = shared + suffix;
+      pos += 1 + suffix;
+    }
+  }
+  return true;
+}
+
+bool WordTable::Write(const char* filename) const {
+  WordTableHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kWordTableMagic, sizeof(kWordTableMagic));
+  header.version = kWordTableVersion;
+  header.num_words = num_words_;
+  header.words_per_block = kWordsPerBlock;
+  header.num_blocks = block_offsets_.size();
+  header.data_bytes = data_.size();
+
+  string tmp_filename = string(filename) + ".tmp";
+  FILE* f = fopen(tmp_filename.c_str(), "wb");
+  if (!f) {
+    fprintf(stderr, "Couldn't open %s\n", tmp_filename.c_str());
+    return false;
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+            fwrite(block_offsets_.data(), sizeof(uint32_t), block_offsets_.size(), f) ==
+                block_offsets_.size() &&
+            fwrite(data_.data(), 1, data_.size(), f) == data_.size();
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp_filename.c_str(), filename) != 0) {
+    fprintf(stderr, "Couldn't write %s\n", filename);
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+string WordTable::Word(uint32_t word_id) const {
+  if (word_id == 0 || word_id > num_words_) {
+    return "";
+  }
+  // Decode from the start of the block up to the word.
+  char letters[kMaxWordLength];
+  size_t length = 0;
+  size_t pos = block_offsets_[(word_id - 1) / kWordsPerBlock];
+  for (uint32_t i = 0; i <= (word_id - 1) % kWordsPerBlock; i++) {
+    size_t shared = data_[pos] >> 4;
+    size_t suffix = data_[pos] & 0xf;
+    memcpy(letters + shared, &data_[pos + 1], suffix);
+    length = shared + suffix;
+    pos += 1 + suffix;
+  }
+  string word;
+  for (size_t i = 0; i < length; i++) {
+    word.push_back(letters[i]);
+    if (letters[i] == 'Q') {
+      word.push_back('U');
+    }
+  }
+  return word;
+}
+
+size_t WordTable::Bytes() const {
+  return sizeof(WordTableHeader) + block_offsets_.size() * sizeof(uint32_t) +
+         data_.size();
+}
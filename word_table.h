@@ -0,0 +1,76 @@
+// Maps ADTDAWG word ids back to their spellings.
+//
+// The ADTDAWG can find a word's id but can only recover its letters by searching, so
+// tools that show words (like a web UI listing a board's words) keep this table next
+// to the four-part files.  Words are stored in id order, which is reverse alphabetical,
+// and front coded in blocks of kWordsPerBlock: the first word of a block is stored
+// whole and every other word as the length of the prefix it shares with the word
+// before it plus the rest of its letters, with both lengths packed into one byte.  A
+// lookup decodes at most one block.  For Lexicon_14 this is ~3.7 bytes a word, about
+// half the size of the word list.
+//
+// The file is a WordTableHeader, the byte offset of every block in the data as 32-bit
+// integers, and then the data.  Words are stored as Boggle words, with "Q" for "QU."
+#ifndef WORD_TABLE_H
+#define WORD_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "adtdawg.h"
+
+// The word table for the four-part Lexicon_14 files.
+#define WORD_TABLE_14 "Word_Table_For_Lexicon_14.dat"
+
+const char kWordTableMagic[8] = {'W', 'O', 'R', 'D', 'T', 'B', 'L', '\0'};
+const uint32_t kWordTableVersion = 1;
+
+struct WordTableHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_words;
+  uint32_t words_per_block;
+  uint32_t num_blocks;
+  uint64_t data_bytes;
+};
+
+class WordTable {
+ public:
+  static const uint32_t kWordsPerBlock = 16;
+  // Lengths are stored in four bits, which is enough for everything in TWL06.
+  static const size_t kMaxWordLength = 15;
+
+  // Lists every word in "dawg."
+  static std::unique_ptr<WordTable> Build(const Adtdawg& dawg);
+  // Reads a table written by Write.  Returns NULL on failure.
+  static std::unique_ptr<WordTable> Load(const char* filename);
+
+  // Writes the table to a temporary file and renames it into place.
+  bool Write(const char* filename) const;
+
+  // Returns the word with id "word_id," spelled with "QU," or an empty string if there
+  // is no such id.
+  std::string Word(uint32_t word_id) const;
+
+  // Ids run from 1 to NumWords(), as in the ADTDAWG.
+  uint32_t NumWords() const { return num_words_; }
+  // The size of the table in memory, which is also its size on disk.
+  size_t Bytes() const;
+
+ private:
+  WordTable() : num_words_(0) {}
+
+  // Returns true if every word decodes within the data and kMaxWordLength letters, so
+  // that Word needs no checks of its own.
+  bool EntriesValid() const;
+
+  uint32_t num_words_;
+  std::vector<uint32_t> block_offsets_;
+  std::vector<uint8_t> data_;
+};
+
+#endif  // WORD_TABLE_H